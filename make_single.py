@@ -24,7 +24,12 @@ pragma_once_hpp = re.compile(r'#pragma once')
 files_to_process = [
     'iostream.hpp',
     'sstream.hpp',
-    'serstream.hpp'
+    'spanstream.hpp',
+    'serstream.hpp',
+    'incremental_extractor.hpp',
+    'static_stream.hpp',
+    'arena.hpp',
+    'scanner.hpp'
 ]
 
 
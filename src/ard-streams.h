@@ -2,5 +2,10 @@
 
 #include <iostream.hpp>
 #include <sstream.hpp>
+#include <spanstream.hpp>
 #include <serstream.hpp>
+#include <incremental_extractor.hpp>
 
+#include <static_stream.hpp>
+#include <arena.hpp>
+#include <scanner.hpp>
@@ -0,0 +1,276 @@
+// Copyright (C) 2019 Vladimir Talybin.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <new>
+#include <type_traits>
+#include <iostream.hpp>
+#include <sstream.hpp>
+
+// Memory resources over a caller supplied buffer and an allocator
+// using them, so that strings and string streams do not fragment
+// the heap.
+namespace ard
+{
+    // Allocates by bumping a pointer through the buffer. Memory is
+    // given back all at once with reset(), only the last allocation
+    // can be freed before that.
+    struct monotonic_arena
+    {
+    protected:
+        char* const begin_;
+        char* const end_;
+        char* top_;
+        char* peak_;
+        size_t misses_ = 0;
+
+    public:
+        monotonic_arena(void* buf, size_t n)
+        : begin_(static_cast<char*>(buf))
+        , end_(begin_ + n)
+        , top_(begin_)
+        , peak_(begin_)
+        { }
+
+        monotonic_arena(const monotonic_arena&) = delete;
+        monotonic_arena& operator=(const monotonic_arena&) = delete;
+
+        // Returns nullptr if there is no room left
+        void* allocate(size_t n, size_t align)
+        {
+            // Checked before forming a pointer past end_
+            const uintptr_t top = reinterpret_cast<uintptr_t>(top_);
+            const size_t pad = (align - top % align) % align;
+            const size_t room = end_ - top_;
+            if (pad > room || room - pad < n) {
+                ++misses_;
+                return nullptr;
+            }
+            char* p = top_ + pad;
+            top_ = p + n;
+            if (top_ > peak_)
+                peak_ = top_;
+            return p;
+        }
+
+        // Memory is kept until reset(), unless p is the last allocation
+        void deallocate(void* p, size_t n)
+        {
+            if (static_cast<char*>(p) + n == top_)
+                top_ = static_cast<char*>(p);
+        }
+
+        // Frees everything at once. Nothing allocated from the arena
+        // may be in use anymore.
+        void reset()
+        { top_ = begin_; }
+
+        bool owns(const void* p) const
+        { return p >= begin_ && p < end_; }
+
+        size_t capacity() const
+        { return end_ - begin_; }
+
+        // Bytes allocated since the last reset()
+        size_t used() const
+        { return top_ - begin_; }
+
+        // Most bytes ever allocated
+        size_t peak() const
+        { return peak_ - begin_; }
+
+        // Allocations that did not fit
+        size_t misses() const
+        { return misses_; }
+    };
+
+    // Splits the buffer into blocks of the same size, allocating one
+    // block at a time. Freed blocks are reused right away.
+    struct block_pool
+    {
+    protected:
+        struct node { node* next; };
+
+        static constexpr size_t align_ = alignof(max_align_t);
+
+        char* const begin_;
+        const size_t block_size_;
+        const size_t count_;
+        // Blocks never allocated since reset() start at next_
+        size_t next_ = 0;
+        node* free_ = nullptr;
+        size_t in_use_ = 0;
+        size_t peak_ = 0;
+        size_t misses_ = 0;
+
+    public:
+        // Blocks hold at least block_size bytes, they are rounded
+        // up to the alignment of max_align_t
+        block_pool(void* buf, size_t n, size_t block_size)
+        : begin_(align_up_(buf))
+        , block_size_(round_(block_size < sizeof(node) ? sizeof(node) : block_size))
+        , count_(n > size_t(begin_ - static_cast<char*>(buf)) ?
+            (n - (begin_ - static_cast<char*>(buf))) / block_size_ : 0)
+        { }
+
+        block_pool(const block_pool&) = delete;
+        block_pool& operator=(const block_pool&) = delete;
+
+        // Returns nullptr if n does not fit a block or all are taken
+        void* allocate(size_t n, size_t align)
+        {
+            void* p = nullptr;
+            if (n <= block_size_ && align <= align_) {
+                if (free_) {
+                    p = free_;
+                    free_ = free_->next;
+                }
+                else if (next_ < count_)
+                    p = begin_ + block_size_ * next_++;
+            }
+            if (!p) {
+                ++misses_;
+                return nullptr;
+            }
+            if (++in_use_ > peak_)
+                peak_ = in_use_;
+            return p;
+        }
+
+        void deallocate(void* p, size_t)
+        {
+            node* b = static_cast<node*>(p);
+            b->next = free_;
+            free_ = b;
+            --in_use_;
+        }
+
+        // Frees all blocks at once. Nothing allocated from the pool
+        // may be in use anymore.
+        void reset()
+        {
+            next_ = 0;
+            free_ = nullptr;
+            in_use_ = 0;
+        }
+
+        bool owns(const void* p) const
+        { return p >= begin_ && p < begin_ + block_size_ * count_; }
+
+        size_t block_size() const
+        { return block_size_; }
+
+        size_t capacity() const
+        { return count_; }
+
+        // Blocks allocated now
+        size_t used() const
+        { return in_use_; }
+
+        // Most blocks ever allocated at once
+        size_t peak() const
+        { return peak_; }
+
+        // Allocations that did not fit
+        size_t misses() const
+        { return misses_; }
+
+    private:
+        static size_t round_(size_t n)
+        { return (n + align_ - 1) / align_ * align_; }
+
+        static char* align_up_(void* p)
+        {
+            const uintptr_t v = reinterpret_cast<uintptr_t>(p);
+            return static_cast<char*>(p) + ((align_ - v % align_) % align_);
+        }
+    };
+
+    // Allocator drawing from a monotonic_arena, block_pool or any
+    // resource with the same allocate(), deallocate() and owns().
+    // What the resource cannot give is allocated on the heap, the
+    // resource counts it in misses().
+    template <class T, class Resource>
+    struct resource_allocator
+    {
+        using value_type = T;
+        using resource_type = Resource;
+
+        // Strings can be moved and swapped without copying
+        using propagate_on_container_move_assignment = std::true_type;
+        using propagate_on_container_swap = std::true_type;
+
+    protected:
+        resource_type* resource_;
+
+    public:
+        resource_allocator(resource_type& r) noexcept
+        : resource_(&r)
+        { }
+
+        template <class U>
+        resource_allocator(const resource_allocator<U, Resource>& a) noexcept
+        : resource_(a.resource())
+        { }
+
+        resource_type* resource() const noexcept
+        { return resource_; }
+
+        T* allocate(size_t n)
+        {
+            void* p = resource_->allocate(n * sizeof(T), alignof(T));
+            if (!p)
+                p = ::operator new(n * sizeof(T));
+            return static_cast<T*>(p);
+        }
+
+        void deallocate(T* p, size_t n)
+        {
+            if (resource_->owns(p))
+                resource_->deallocate(p, n * sizeof(T));
+            else
+                ::operator delete(p);
+        }
+
+        template <class U>
+        friend bool operator==(const resource_allocator& a,
+                               const resource_allocator<U, Resource>& b) noexcept
+        { return a.resource() == b.resource(); }
+
+        template <class U>
+        friend bool operator!=(const resource_allocator& a,
+                               const resource_allocator<U, Resource>& b) noexcept
+        { return !(a == b); }
+    };
+
+    //
+    // Alias
+    //
+
+    template <class T>
+    using arena_allocator = resource_allocator<T, monotonic_arena>;
+
+    template <class T>
+    using pool_allocator = resource_allocator<T, block_pool>;
+
+    using arena_string = std::basic_string<char, std::char_traits<char>, arena_allocator<char>>;
+    using arena_ostringstream = basic_ostringstream<char, std::char_traits<char>, arena_allocator<char>>;
+    using arena_stringstream = basic_stringstream<char, std::char_traits<char>, arena_allocator<char>>;
+
+    using pool_ostringstream = basic_ostringstream<char, std::char_traits<char>, pool_allocator<char>>;
+
+} // namespace ard
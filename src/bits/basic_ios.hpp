@@ -26,48 +26,23 @@
 
 namespace ard
 {
-    // Template class basic_ios, virtual base class for all
-    // stream classes.
-    //
-    // Param CharT  - Type of character stream.
-    // Param Traits - Traits for character type.
-    //
-    // Most of the member functions called dispatched on stream objects
-    // (e.g., std::cout.foo(bar);) are consolidated in this class.
-    //
-    template <class CharT, class Traits = std::char_traits<CharT>>
-    struct basic_ios : ios_base
+    // State, fill character and stream buffer of a stream over the
+    // stream buffer type Buf. Base of basic_ios and of static_ios,
+    // which has Buf known at compile time.
+    template <class Buf>
+    struct ios_state : ios_base
     {
-        // These are standard types. They permit a standardized way of
-        // referring to names of (or names dependent on) the template
-        // parameters, which are specific to the implementation.
-        using char_type = CharT;
-        using traits_type = Traits;
+        using char_type = typename Buf::char_type;
+        using traits_type = typename Buf::traits_type;
         using int_type = typename traits_type::int_type;
-        using pos_type = typename traits_type::pos_type;
-        using off_type = typename traits_type::off_type;
 
-        // These are non-standard types.
         using ctype_type = ctype<char_type>;
-        using num_put_type =
-            num_put<char_type, ostreambuf_iterator<char_type, traits_type>>;
-        using num_get_type =
-            num_get<char_type, istreambuf_iterator<char_type, traits_type>>;
-
-        using ostream_type = basic_ostream<char_type, traits_type>;
-        using streambuf_type = basic_streambuf<char_type, traits_type>;
+        using streambuf_type = Buf;
 
     protected:
-        // Data members
-        ostream_type* tie_ = nullptr;
         char_type fill_ = { };
         streambuf_type* streambuf_ = nullptr;
 
-        // For ostream
-        num_put_type num_put_;
-        // For istream
-        num_get_type num_get_;
-
     public:
         // The quick-and-easy status check.
         //
@@ -138,12 +113,111 @@ namespace ard
         bool bad() const
         { return this->rdstate() & badbit; }
 
+        // Accessing the underlying buffer.
+        // Return the current stream buffer.
+        //
+        // This does not change the state of the stream.
+        //
+        streambuf_type* rdbuf() const
+        { return streambuf_; }
+
+        // Retrieves the empty character.
+        // Return the current fill character.
+        //
+        // It defaults to a space (' ') in the current locale.
+        //
+        char_type fill() const
+        { return fill_; }
+
+        // Sets a new empty character.
+        // Param ch - The new character.
+        // Return the previous fill character.
+        //
+        // The fill character is used to fill out space when P+ characters
+        // have been requested (e.g., via setw), Q characters are actually
+        // used, and Q < P. It defaults to a space (' ') in the current locale.
+        //
+        char_type fill(char_type ch)
+        {
+            char_type old = fill_;
+            fill_ = ch;
+            return old;
+        }
+
+        // Widens characters.
+        // Param c - The character to widen.
+        // Return the widened character.
+        //
+        // Maps a character of char to a character of char_type.
+        // Returns the result of
+        //
+        // ard::ctype<char_type>::widen(c)
+        //
+        // Additional l10n notes are at
+        // http://gcc.gnu.org/onlinedocs/libstdc++/manual/localization.html
+        //
+        char_type widen(char c) const
+        { return ctype_type::widen(c); }
+
+    protected:
+        ios_state() = default;
+
+        ios_state(const ios_state&) = delete;
+        ios_state& operator=(const ios_state&) = delete;
+
+        void init(streambuf_type* sb)
+        {
+            fill_ = this->widen(' ');
+            streambuf_ = sb;
+            streambuf_state_ = sb ? goodbit : badbit;
+        }
+    };
+
+    // Template class basic_ios, virtual base class for all
+    // stream classes.
+    //
+    // Param CharT  - Type of character stream.
+    // Param Traits - Traits for character type.
+    //
+    // Most of the member functions called dispatched on stream objects
+    // (e.g., std::cout.foo(bar);) are consolidated in this class.
+    //
+    template <class CharT, class Traits = std::char_traits<CharT>>
+    struct basic_ios : ios_state<basic_streambuf<CharT, Traits>>
+    {
+        // These are standard types. They permit a standardized way of
+        // referring to names of (or names dependent on) the template
+        // parameters, which are specific to the implementation.
+        using char_type = CharT;
+        using traits_type = Traits;
+        using int_type = typename traits_type::int_type;
+        using pos_type = typename traits_type::pos_type;
+        using off_type = typename traits_type::off_type;
+
+        // These are non-standard types.
+        using ctype_type = ctype<char_type>;
+        using num_put_type =
+            num_put<char_type, ostreambuf_iterator<char_type, traits_type>>;
+        using num_get_type =
+            num_get<char_type, istreambuf_iterator<char_type, traits_type>>;
+
+        using ostream_type = basic_ostream<char_type, traits_type>;
+        using streambuf_type = basic_streambuf<char_type, traits_type>;
+        using ios_state_type = ios_state<streambuf_type>;
+
+    protected:
+        // Data members
+        ostream_type* tie_ = nullptr;
+
+    public:
+        // Otherwise hidden by rdbuf(streambuf_type*)
+        using ios_state_type::rdbuf;
+
         // Constructor performs initialization.
         //
         // The parameter is passed by derived streams.
         //
         explicit basic_ios(streambuf_type* sb)
-        : ios_base()
         { this->init(sb); }
 
         // Empty.
@@ -179,14 +253,6 @@ namespace ard
             return old;
         }
 
-        // Accessing the underlying buffer.
-        // Return the current stream buffer.
-        //
-        // This does not change the state of the stream.
-        //
-        streambuf_type* rdbuf() const
-        { return streambuf_; }
-
         // Changing the underlying buffer.
         // Param sb - The new stream buffer.
         // Return the previous stream buffer.
@@ -208,8 +274,8 @@ namespace ard
         //
         streambuf_type* rdbuf(streambuf_type* sb)
         {
-            streambuf_type* old = streambuf_;
-            streambuf_ = sb;
+            streambuf_type* old = this->streambuf_;
+            this->streambuf_ = sb;
             this->clear();
             return old;
         }
@@ -236,44 +302,6 @@ namespace ard
             return *this;
         }
 
-        // Retrieves the empty character.
-        // Return the current fill character.
-        //
-        // It defaults to a space (' ') in the current locale.
-        //
-        char_type fill() const
-        { return fill_; }
-
-        // Sets a new empty character.
-        // Param ch - The new character.
-        // Return the previous fill character.
-        //
-        // The fill character is used to fill out space when P+ characters
-        // have been requested (e.g., via setw), Q characters are actually
-        // used, and Q < P. It defaults to a space (' ') in the current locale.
-        //
-        char_type fill(char_type ch)
-        {
-            char_type old = fill_;
-            fill_ = ch;
-            return old;
-        }
-
-        // Widens characters.
-        // Param c - The character to widen.
-        // Return the widened character.
-        //
-        // Maps a character of char to a character of char_type.
-        // Returns the result of
-        //
-        // ard::ctype<char_type>::widen(c)
-        //
-        // Additional l10n notes are at
-        // http://gcc.gnu.org/onlinedocs/libstdc++/manual/localization.html
-        //
-        char_type widen(char c) const
-        { return ctype_type::widen(c); }
-
     protected:
         // 27.4.5.1 basic_ios constructors
 
@@ -294,18 +322,16 @@ namespace ard
         //
         void init(streambuf_type* sb)
         {
-            fill_ = this->widen(' ');
+            ios_state_type::init(sb);
             tie_ = nullptr;
-            streambuf_ = sb;
-            streambuf_state_ = sb ? goodbit : badbit;
         }
 
         void move(basic_ios& rhs)
         {
             ios_base::move_(rhs);
             this->tie(rhs.tie(nullptr));
-            fill_ = rhs.fill_;
-            streambuf_ = nullptr;
+            this->fill_ = rhs.fill_;
+            this->streambuf_ = nullptr;
         }
 
         void move(basic_ios&& rhs)
@@ -315,8 +341,12 @@ namespace ard
         {
             ios_base::swap_(rhs);
             std::swap(tie_, rhs.tie_);
-            std::swap(fill_, rhs.fill_);
+            std::swap(this->fill_, rhs.fill_);
         }
+
+        // Used by moving stream classes, the state is kept
+        void set_rdbuf(streambuf_type* sb)
+        { this->streambuf_ = sb; }
     };
 
 } // namespace ard
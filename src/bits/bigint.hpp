@@ -0,0 +1,283 @@
+// Copyright (C) 2019 Vladimir Talybin.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+#include <stdint.h>
+
+namespace ard
+{
+    // Unsigned integer of at most N 32-bit limbs, the little needed
+    // for exact conversion of floating point values to and from
+    // decimal. Only 32x32 bit multiplication and 32-bit division
+    // are used. There is no overflow check, N must be large enough.
+    template <size_t N>
+    struct bigint
+    {
+        using limb_type = uint32_t;
+        using wide_type = uint64_t;
+
+    protected:
+        // Least significant limb first, size_ is the number of used
+        // limbs, so the most significant is never zero
+        limb_type limbs_[N];
+        size_t size_ = 0;
+
+    public:
+        bigint()
+        { }
+
+        explicit bigint(unsigned long long v)
+        { assign(v); }
+
+        // Copy only the used limbs
+        bigint(const bigint& b)
+        { *this = b; }
+
+        bigint& operator=(const bigint& b)
+        {
+            size_ = b.size_;
+            for (size_t i = 0; i < size_; ++i)
+                limbs_[i] = b.limbs_[i];
+            return *this;
+        }
+
+        void assign(unsigned long long v)
+        {
+            size_ = 0;
+            for (; v; v >>= 32)
+                limbs_[size_++] = limb_type(v);
+        }
+
+        bool is_zero() const
+        { return !size_; }
+
+        // Value of the lower 64 bits
+        unsigned long long to_ull() const
+        {
+            unsigned long long v = 0;
+            for (size_t i = size_ < 2 ? size_ : 2; i-- > 0; )
+                v = (v << 32) | limbs_[i];
+            return v;
+        }
+
+        // Number of significant bits
+        size_t bit_length() const;
+
+        // Bits [pos, pos + 32) as an integer
+        limb_type bits(size_t pos) const;
+
+        // Returns <0, 0 or >0 if *this is less, equal or greater than b
+        int compare(const bigint& b) const;
+
+        // *this += a
+        void add_small(limb_type a);
+
+        // *this *= m
+        void mul_small(limb_type m);
+
+        // *this *= 10^n
+        void mul_pow10(int n);
+
+        // *this <<= n
+        void shl(size_t n);
+
+        // *this -= q * b, the result must not be negative
+        void sub_mul(const bigint& b, limb_type q);
+
+        // Divides by b when *this < 10 * b. The remainder is left
+        // in *this, returns the quotient (a decimal digit).
+        limb_type div_digit(const bigint& b);
+
+        // Divides by b when *this < b * 2^32. The remainder is left
+        // in *this, returns the quotient.
+        limb_type div_limb(const bigint& b);
+
+    private:
+        void trim_()
+        {
+            while (size_ && !limbs_[size_ - 1])
+                --size_;
+        }
+    };
+
+
+    //
+    // Methods
+    //
+
+    template <size_t N>
+    inline size_t bigint<N>::bit_length() const
+    {
+        if (!size_)
+            return 0;
+        // Long is at least 32 bits
+        return size_ * 32 - __builtin_clzl(limbs_[size_ - 1]) +
+            (sizeof(long) - sizeof(limb_type)) * 8;
+    }
+
+    template <size_t N>
+    inline typename bigint<N>::limb_type bigint<N>::bits(size_t pos) const
+    {
+        const size_t i = pos / 32;
+        const size_t s = pos % 32;
+        if (i >= size_)
+            return 0;
+
+        limb_type v = limbs_[i] >> s;
+        if (s && i + 1 < size_)
+            v |= limbs_[i + 1] << (32 - s);
+        return v;
+    }
+
+    template <size_t N>
+    inline int bigint<N>::compare(const bigint& b) const
+    {
+        if (size_ != b.size_)
+            return size_ < b.size_ ? -1 : 1;
+        for (size_t i = size_; i-- > 0; ) {
+            if (limbs_[i] != b.limbs_[i])
+                return limbs_[i] < b.limbs_[i] ? -1 : 1;
+        }
+        return 0;
+    }
+
+    template <size_t N>
+    inline void bigint<N>::add_small(limb_type a)
+    {
+        for (size_t i = 0; a && i < size_; ++i) {
+            limbs_[i] += a;
+            // Carry
+            a = limbs_[i] < a;
+        }
+        if (a)
+            limbs_[size_++] = a;
+    }
+
+    template <size_t N>
+    inline void bigint<N>::mul_small(limb_type m)
+    {
+        limb_type carry = 0;
+        for (size_t i = 0; i < size_; ++i) {
+            const wide_type p = wide_type(limbs_[i]) * m + carry;
+            limbs_[i] = limb_type(p);
+            carry = limb_type(p >> 32);
+        }
+        if (carry)
+            limbs_[size_++] = carry;
+        else if (!m)
+            size_ = 0;
+    }
+
+    template <size_t N>
+    inline void bigint<N>::mul_pow10(int n)
+    {
+        static const limb_type pow10[] = {
+            1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000
+        };
+        for (; n >= 9; n -= 9)
+            mul_small(1000000000u);
+        if (n)
+            mul_small(pow10[n]);
+    }
+
+    template <size_t N>
+    inline void bigint<N>::shl(size_t n)
+    {
+        if (!size_)
+            return;
+
+        const size_t s = n % 32;
+        if (s) {
+            limb_type carry = 0;
+            for (size_t i = 0; i < size_; ++i) {
+                const limb_type l = limbs_[i];
+                limbs_[i] = (l << s) | carry;
+                carry = l >> (32 - s);
+            }
+            if (carry)
+                limbs_[size_++] = carry;
+        }
+
+        const size_t k = n / 32;
+        if (k) {
+            for (size_t i = size_; i-- > 0; )
+                limbs_[i + k] = limbs_[i];
+            for (size_t i = 0; i < k; ++i)
+                limbs_[i] = 0;
+            size_ += k;
+        }
+    }
+
+    template <size_t N>
+    inline void bigint<N>::sub_mul(const bigint& b, limb_type q)
+    {
+        // High part of the product and the borrow
+        limb_type borrow = 0;
+        for (size_t i = 0; i < b.size_; ++i) {
+            const wide_type p = wide_type(b.limbs_[i]) * q + borrow;
+            const limb_type lo = limb_type(p);
+            borrow = limb_type(p >> 32) + (limbs_[i] < lo);
+            limbs_[i] -= lo;
+        }
+        for (size_t i = b.size_; borrow; ++i) {
+            const limb_type l = limbs_[i];
+            limbs_[i] = l - borrow;
+            borrow = l < borrow;
+        }
+        trim_();
+    }
+
+    template <size_t N>
+    inline typename bigint<N>::limb_type bigint<N>::div_digit(const bigint& b)
+    {
+        const size_t len = b.bit_length();
+        if (bit_length() < len)
+            return 0;
+
+        // Estimate from the top 28 bits of b. It is never above the
+        // quotient and off by at most one or two, since *this < 10 * b
+        // keeps the top bits of *this within 32 bits.
+        const size_t pos = len > 28 ? len - 28 : 0;
+        limb_type q = bits(pos) / (b.bits(pos) + 1);
+        if (q)
+            sub_mul(b, q);
+
+        for (; compare(b) >= 0; ++q)
+            sub_mul(b, 1);
+        return q;
+    }
+
+    template <size_t N>
+    inline typename bigint<N>::limb_type bigint<N>::div_limb(const bigint& b)
+    {
+        const size_t len = b.bit_length();
+        if (bit_length() < len)
+            return 0;
+
+        // The top 64 bits of *this hold the whole quotient. Exact if
+        // b is one limb, otherwise estimated from the top 32 bits of
+        // b, never above the quotient and off by at most three.
+        const size_t pos = len > 32 ? len - 32 : 0;
+        const wide_type top = (wide_type(bits(pos + 32)) << 32) | bits(pos);
+        limb_type q = limb_type(top / (wide_type(b.bits(pos)) + (len > 32)));
+        if (q)
+            sub_mul(b, q);
+
+        for (; compare(b) >= 0; ++q)
+            sub_mul(b, 1);
+        return q;
+    }
+
+} // namespace ard
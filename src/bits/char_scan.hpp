@@ -0,0 +1,176 @@
+// Copyright (C) 2019 Vladimir Talybin.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) && defined(__BYTE_ORDER__) && \
+      __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#include <arm_neon.h>
+#define ARD_CHAR_SCAN_NEON
+#endif
+
+// Scanning character ranges a vector or a word at a time
+namespace ard
+{
+    // Space, \t, \n, \v, \f or \r, as isspace() in the "C" locale
+    inline bool is_wsp(char c)
+    { return c == ' ' || static_cast<unsigned char>(c - '\t') < 5; }
+
+    namespace scan_detail
+    {
+#if defined(__AVX2__)
+        // Bit per character of v that is whitespace
+        inline unsigned wsp_mask_(__m256i v)
+        {
+            const __m256i t = _mm256_sub_epi8(v, _mm256_set1_epi8('\t'));
+            const __m256i ws = _mm256_or_si256(
+                _mm256_cmpeq_epi8(v, _mm256_set1_epi8(' ')),
+                _mm256_cmpeq_epi8(_mm256_min_epu8(t, _mm256_set1_epi8(4)), t));
+            return unsigned(_mm256_movemask_epi8(ws));
+        }
+#elif defined(__SSE2__)
+        inline unsigned wsp_mask_(__m128i v)
+        {
+            const __m128i t = _mm_sub_epi8(v, _mm_set1_epi8('\t'));
+            const __m128i ws = _mm_or_si128(
+                _mm_cmpeq_epi8(v, _mm_set1_epi8(' ')),
+                _mm_cmpeq_epi8(_mm_min_epu8(t, _mm_set1_epi8(4)), t));
+            return unsigned(_mm_movemask_epi8(ws));
+        }
+#elif defined(ARD_CHAR_SCAN_NEON)
+        // Four bits per character of v that is whitespace
+        inline uint64_t wsp_mask_(uint8x16_t v)
+        {
+            const uint8x16_t ws = vorrq_u8(
+                vceqq_u8(v, vdupq_n_u8(' ')),
+                vcleq_u8(vsubq_u8(v, vdupq_n_u8('\t')), vdupq_n_u8(4)));
+            const uint8x8_t m = vshrn_n_u16(vreinterpretq_u16_u8(ws), 4);
+            return vget_lane_u64(vreinterpret_u64_u8(m), 0);
+        }
+#else
+        using word_type = size_t;
+
+        constexpr word_type ones_ = word_type(-1) / 0xff;
+        constexpr word_type high_ = ones_ * 0x80;
+
+        // High bit of each byte of w that is whitespace. Exact, no
+        // carry crosses a byte.
+        inline word_type wsp_mask_(word_type w)
+        {
+            const word_type low = w & ~high_;
+            const word_type sp = low ^ (ones_ * ' ');
+            const word_type is_sp = ~((sp + ~high_) | sp);
+            const word_type ge_tab = low + ones_ * (0x80 - '\t');
+            const word_type ge_cr = low + ones_ * (0x80 - '\r' - 1);
+            return (is_sp | (ge_tab & ~ge_cr)) & ~w & high_;
+        }
+#endif
+
+        // First character in [first, last) for which is_wsp() is Wsp
+        template <bool Wsp>
+        inline const char* find_(const char* first, const char* last)
+        {
+#if defined(__AVX2__)
+            for (; last - first >= 32; first += 32) {
+                const unsigned ws = wsp_mask_(
+                    _mm256_loadu_si256(reinterpret_cast<const __m256i*>(first)));
+                if (const unsigned m = Wsp ? ws : ~ws)
+                    return first + __builtin_ctz(m);
+            }
+            if (last - first >= 16) {
+                const unsigned ws = wsp_mask_(_mm256_castsi128_si256(
+                    _mm_loadu_si128(reinterpret_cast<const __m128i*>(first))));
+                if (const unsigned m = (Wsp ? ws : ~ws) & 0xffff)
+                    return first + __builtin_ctz(m);
+                first += 16;
+            }
+#elif defined(__SSE2__)
+            for (; last - first >= 16; first += 16) {
+                const unsigned ws = wsp_mask_(
+                    _mm_loadu_si128(reinterpret_cast<const __m128i*>(first)));
+                if (const unsigned m = (Wsp ? ws : ~ws) & 0xffff)
+                    return first + __builtin_ctz(m);
+            }
+#elif defined(ARD_CHAR_SCAN_NEON)
+            for (; last - first >= 16; first += 16) {
+                const uint64_t ws = wsp_mask_(vld1q_u8(reinterpret_cast<const uint8_t*>(first)));
+                if (const uint64_t m = Wsp ? ws : ~ws)
+                    return first + (__builtin_ctzll(m) >> 2);
+            }
+#else
+            // Not worth it on 8 and 16 bit targets
+            if (sizeof(word_type) >= 4) {
+                for (; size_t(last - first) >= sizeof(word_type); first += sizeof(word_type)) {
+                    word_type w;
+                    memcpy(&w, first, sizeof(w));
+                    if (wsp_mask_(w) != (Wsp ? 0 : high_))
+                        break;
+                }
+            }
+#endif
+            while (first != last && is_wsp(*first) != Wsp)
+                ++first;
+            return first;
+        }
+    }
+
+    // First character in [first, last) that is whitespace, or last
+    inline const char* find_wsp(const char* first, const char* last)
+    { return scan_detail::find_<true>(first, last); }
+
+    // First character in [first, last) that is not whitespace, or last
+    inline const char* find_not_wsp(const char* first, const char* last)
+    { return scan_detail::find_<false>(first, last); }
+
+    // First c in [first, last), or last. The C library memchr() is
+    // vectorized or works a word at a time on most targets.
+    inline const char* find_char(const char* first, const char* last, char c)
+    {
+        const void* p = first != last ? memchr(first, c, last - first) : nullptr;
+        return p ? static_cast<const char*>(p) : last;
+    }
+
+    // Skips whitespace in the stream buffer sb and returns the
+    // character after it, or eof. A run of whitespace in the get
+    // area is skipped at once, underflow() is called at its end.
+    template <class Streambuf>
+    inline typename Streambuf::int_type skip_wsp(Streambuf* sb)
+    {
+        using traits_type = typename Streambuf::traits_type;
+        typename Streambuf::int_type c = sb->sgetc();
+        while (!traits_type::eq_int_type(c, traits_type::eof()) &&
+               is_wsp(traits_type::to_char_type(c)))
+        {
+            const char* p = find_not_wsp(sb->gptr(), sb->egptr());
+            if (p != sb->gptr()) {
+                sb->sgetconsume(p - sb->gptr());
+                c = sb->sgetc();
+            }
+            else
+                c = sb->snextc();
+        }
+        return c;
+    }
+
+} // namespace ard
+
+#undef ARD_CHAR_SCAN_NEON
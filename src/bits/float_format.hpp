@@ -0,0 +1,435 @@
+// Copyright (C) 2019 Vladimir Talybin.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+#include <cmath>
+#include <limits>
+#include <bits/ios_base.hpp>
+#include <bits/bigint.hpp>
+
+namespace ard
+{
+    // Formats a floating point value as printf does for the %f, %e,
+    // %g and %a conversions (selected by floatfield), honoring
+    // precision, showpoint, showpos and uppercase. The decimal digits
+    // are exact and correctly rounded, ties to even. Usage:
+    //
+    //   float_decimal<double> fd(v, flags, prec);
+    //   char digits[fd.digits_size()];
+    //   fd.generate(digits);
+    //   char cs[fd.length()];
+    //   fd.format(cs);
+    template <class ValueT>
+    struct float_decimal
+    {
+        using value_type = ValueT;
+        using limits = std::numeric_limits<value_type>;
+
+    private:
+        // Bits of the scaled value r / s, see to_digits_()
+        static constexpr int max_bits_ =
+            (limits::max_exponent > limits::digits - limits::min_exponent ?
+             limits::max_exponent : limits::digits - limits::min_exponent) + 16;
+        using bigint_type = bigint<(max_bits_ + 31) / 32>;
+
+        // Most digits of the exact decimal expansion of a finite value
+        static constexpr int max_digits_ =
+            limits::max_exponent10 + limits::digits - limits::min_exponent + 2;
+
+        // Mantissa, float stays within 32 bits
+        using mant_type = std::conditional_t<
+            (limits::digits <= 32), uint32_t, unsigned long long>;
+
+        enum conversion_ { fixed_, scientific_, general_, hex_ };
+
+        const ios_base::fmtflags flags_;
+        int prec_;
+        conversion_ conv_;
+        bool neg_;
+        bool finite_;
+        bool nan_;
+
+        // Absolute value is mant_ * 2^exp2_, mant_ has limits::digits
+        // bits unless value is zero
+        mant_type mant_ = 0;
+        int exp2_ = 0;
+
+        // Significant digits (the rest are zeros) and the decimal
+        // exponent of the first one
+        const char* digits_ = nullptr;
+        int nd_ = 0;
+        int exp10_ = 0;
+
+    public:
+        float_decimal(value_type v, ios_base::fmtflags flags, std::streamsize prec);
+
+        // Size of the buffer for generate()
+        int digits_size() const;
+
+        // Generate the decimal digits into buf, which must be
+        // valid until format()
+        void generate(char* buf);
+
+        // Length of the formatted value
+        int length() const;
+
+        // Write the formatted value, length() characters
+        void format(char* out) const;
+
+    private:
+        int to_digits_(char* buf, int size);
+
+        char sign_() const
+        { return neg_ ? '-' : ((flags_ & ios_base::showpos) ? '+' : 0); }
+
+        char digit_(int i) const
+        { return (i >= 0 && i < nd_) ? digits_[i] : '0'; }
+
+        // Leading digit, fraction and exponent of the hexadecimal
+        // mantissa. Subnormals are written with a leading zero and
+        // the minimum exponent, as glibc does. A 64-bit mantissa with
+        // explicit integer bit (x87 long double) has a whole digit
+        // before the point, 0x8p-3 for 1. Fraction is aligned to
+        // whole digits, returns the number of digits after the point.
+        int hex_frac_(int& lead, mant_type& frac, int& e) const;
+
+        static int exp_len_(int e, int min)
+        {
+            int n = 1;
+            for (e = e < 0 ? -e : e; e >= 10; e /= 10)
+                ++n;
+            return n < min ? min : n;
+        }
+
+        static char* write_exp_(char* p, char c, int e, int min)
+        {
+            *p++ = c;
+            *p++ = e < 0 ? '-' : '+';
+            const int n = exp_len_(e, min);
+            e = e < 0 ? -e : e;
+            for (int i = n; i-- > 0; e /= 10)
+                p[i] = '0' + e % 10;
+            return p + n;
+        }
+    };
+
+
+    //
+    // Methods
+    //
+
+    template <class ValueT>
+    inline float_decimal<ValueT>::
+    float_decimal(value_type v, ios_base::fmtflags flags, std::streamsize prec)
+    : flags_(flags)
+    , prec_(int(prec < 0 ? 6 : prec))
+    , neg_(std::signbit(v))
+    , finite_(std::isfinite(v))
+    , nan_(std::isnan(v))
+    {
+        const ios_base::fmtflags fltfield = flags & ios_base::floatfield;
+        if (fltfield == ios_base::fixed)
+            conv_ = fixed_;
+        else if (fltfield == ios_base::scientific)
+            conv_ = scientific_;
+        else if (fltfield == ios_base::floatfield)
+            conv_ = hex_;
+        else
+            conv_ = general_;
+
+        if (finite_ && v != 0) {
+            int e;
+            const value_type fr = std::frexp(neg_ ? -v : v, &e);
+            mant_ = static_cast<mant_type>(std::ldexp(fr, limits::digits));
+            exp2_ = e - limits::digits;
+        }
+    }
+
+    template <class ValueT>
+    inline int float_decimal<ValueT>::digits_size() const
+    {
+        if (!mant_ || conv_ == hex_)
+            return 1;
+
+        int n;
+        if (conv_ == fixed_) {
+            // Above the decimal exponent of the value, which is below
+            // 2^(exp2_ + digits)
+            const int k = (((exp2_ + limits::digits) * 78913) >> 18) + 1;
+            n = k + 1 + prec_;
+        }
+        else
+            n = prec_ + 1;
+        return n < 1 ? 1 : (n > max_digits_ ? max_digits_ : n);
+    }
+
+    template <class ValueT>
+    inline void float_decimal<ValueT>::generate(char* buf)
+    {
+        digits_ = buf;
+        if (!finite_ || conv_ == hex_)
+            return;
+        if (mant_)
+            nd_ = to_digits_(buf, digits_size());
+
+        if (conv_ == general_) {
+            // Style e is used if the exponent is less than -4 or greater
+            // than or equal to the precision, as per C99 7.19.6.1
+            const int p = prec_ ? prec_ : 1;
+            int frac;
+            if (p > exp10_ && exp10_ >= -4) {
+                conv_ = fixed_;
+                prec_ = p - 1 - exp10_;
+                frac = nd_ - 1 - exp10_;
+            }
+            else {
+                conv_ = scientific_;
+                prec_ = p - 1;
+                frac = nd_ - 1;
+            }
+            // Trailing zeros are removed unless showpoint
+            if (!(flags_ & ios_base::showpoint))
+                prec_ = frac < 0 ? 0 : (frac < prec_ ? frac : prec_);
+        }
+    }
+
+    // Digits are generated from r / s, which is kept in [0, 10) by
+    // scaling with the decimal exponent k, so that each digit is a
+    // small quotient. Generation stops at the rounding position
+    // or when the rest is zero.
+    template <class ValueT>
+    inline int float_decimal<ValueT>::to_digits_(char* buf, int size)
+    {
+        mant_type m = mant_;
+        int e = exp2_;
+        for (; !(m & 1); m >>= 1)
+            ++e;
+
+        int bits = 0;
+        for (mant_type t = m; t; t >>= 1)
+            ++bits;
+
+        // Estimate of floor(log10(v)), corrected below
+        int k = ((e + bits - 1) * 78913) >> 18;
+
+        bigint_type r(m);
+        bigint_type s(1);
+        if (e >= 0)
+            r.shl(e);
+        else
+            s.shl(-e);
+        if (k >= 0)
+            s.mul_pow10(k);
+        else
+            r.mul_pow10(-k);
+
+        // Correct the estimate, so that s <= r < 10 * s
+        while (r.compare(s) < 0) {
+            r.mul_small(10);
+            --k;
+        }
+        while (true) {
+            bigint_type t = s;
+            t.mul_small(10);
+            if (r.compare(t) < 0)
+                break;
+            s = t;
+            ++k;
+        }
+
+        int want;
+        if (conv_ == fixed_)
+            want = k + 1 + prec_;
+        else if (conv_ == scientific_)
+            want = prec_ + 1;
+        else
+            want = prec_ ? prec_ : 1;
+        const int n = want < size ? want : size;
+
+        // Digits, then the rest compared to half of the last digit
+        int nd = 0;
+        bool rest;
+        int half = 0;
+        const size_t sbits = s.bit_length();
+        if (sbits <= 28) {
+            // Fits in 32 bits, 10 * s included
+            uint32_t r32 = r.bits(0);
+            const uint32_t s32 = s.bits(0);
+            for (; nd < n && r32; ++nd) {
+                const uint32_t q = r32 / s32;
+                buf[nd] = '0' + q;
+                r32 = (r32 - q * s32) * 10;
+            }
+            rest = r32;
+            if (rest)
+                half = r32 < s32 * 5 ? -1 : (r32 > s32 * 5);
+        }
+        else if (sbits <= 60 && sizeof(mant_type) > 4) {
+            // Small enough for 64-bit arithmetic, not used for float
+            // to keep it in 32-bit arithmetic
+            unsigned long long r64 = r.to_ull();
+            const unsigned long long s64 = s.to_ull();
+            for (; nd < n && r64; ++nd) {
+                const unsigned q = unsigned(r64 / s64);
+                buf[nd] = '0' + q;
+                r64 = (r64 - q * s64) * 10;
+            }
+            rest = r64;
+            if (rest)
+                half = r64 < s64 * 5 ? -1 : (r64 > s64 * 5);
+        }
+        else {
+            for (; nd < n && !r.is_zero(); ++nd) {
+                buf[nd] = '0' + r.div_digit(s);
+                r.mul_small(10);
+            }
+            rest = !r.is_zero();
+            if (rest) {
+                s.mul_small(5);
+                half = r.compare(s);
+            }
+        }
+
+        // Round half to even, r / s is ten times the rest
+        if (nd == n && rest) {
+            if (half > 0 || (half == 0 && nd && (buf[nd - 1] & 1))) {
+                while (nd && buf[nd - 1] == '9')
+                    --nd;
+                if (nd)
+                    ++buf[nd - 1];
+                else {
+                    buf[nd++] = '1';
+                    ++k;
+                }
+            }
+        }
+
+        // Trailing zeros are implied
+        while (nd && buf[nd - 1] == '0')
+            --nd;
+        exp10_ = k;
+        return nd;
+    }
+
+    template <class ValueT>
+    inline int float_decimal<ValueT>::
+    hex_frac_(int& lead, mant_type& frac, int& e) const
+    {
+        lead = 0;
+        frac = 0;
+        e = 0;
+        if (!mant_)
+            return 0;
+
+        const int fbits = limits::digits == 64 ? 60 : limits::digits - 1;
+        const int emin = limits::min_exponent - 1 - (limits::digits - 1 - fbits);
+        e = exp2_ + fbits;
+
+        // Float is written as promoted to double, where it is normal
+        mant_type m = mant_;
+        if (e < emin && !std::is_same<value_type, float>::value) {
+            m >>= emin - e;
+            e = emin;
+        }
+        lead = int(m >> fbits);
+
+        int n = (fbits + 3) / 4;
+        frac = (m & ((mant_type(1) << fbits) - 1)) << (n * 4 - fbits);
+        for (; n && !(frac & 0xf); --n)
+            frac >>= 4;
+        return n;
+    }
+
+    template <class ValueT>
+    inline int float_decimal<ValueT>::length() const
+    {
+        int len = sign_() ? 1 : 0;
+        if (!finite_)
+            return len + 3;
+
+        const bool point = prec_ || (flags_ & ios_base::showpoint);
+        if (conv_ == hex_) {
+            int lead, e;
+            mant_type frac;
+            const int n = hex_frac_(lead, frac, e);
+            return len + 3 + (n || (flags_ & ios_base::showpoint)) + n + 2 + exp_len_(e, 1);
+        }
+        if (conv_ == fixed_)
+            len += (nd_ && exp10_ >= 0) ? exp10_ + 1 : 1;
+        else
+            len += 1 + 2 + exp_len_(exp10_, 2);
+        return len + point + prec_;
+    }
+
+    template <class ValueT>
+    inline void float_decimal<ValueT>::format(char* p) const
+    {
+        const bool upper = flags_ & ios_base::uppercase;
+        const bool showpoint = flags_ & ios_base::showpoint;
+
+        if (const char c = sign_())
+            *p++ = c;
+
+        if (!finite_) {
+            // Fixed is %f, never uppercase
+            const bool u = upper && conv_ != fixed_;
+            const char* name = nan_ ? (u ? "NAN" : "nan") : (u ? "INF" : "inf");
+            for (int i = 0; i < 3; ++i)
+                *p++ = name[i];
+            return;
+        }
+
+        if (conv_ == hex_) {
+            int lead, e;
+            mant_type frac;
+            int n = hex_frac_(lead, frac, e);
+            const char* xdigits = upper ? "0123456789ABCDEF" : "0123456789abcdef";
+
+            *p++ = '0';
+            *p++ = upper ? 'X' : 'x';
+            *p++ = xdigits[lead];
+            if (n || showpoint)
+                *p++ = '.';
+            while (n--)
+                *p++ = xdigits[(frac >> (n * 4)) & 0xf];
+            write_exp_(p, upper ? 'P' : 'p', e, 1);
+            return;
+        }
+
+        int i = 0;
+        if (conv_ == fixed_) {
+            // Integer part
+            if (nd_ && exp10_ >= 0) {
+                for (; i <= exp10_; ++i)
+                    *p++ = digit_(i);
+            }
+            else {
+                *p++ = '0';
+                i = exp10_ + 1;
+            }
+        }
+        else
+            *p++ = digit_(i++);
+
+        if (prec_ || showpoint)
+            *p++ = '.';
+        for (int j = 0; j < prec_; ++j)
+            *p++ = digit_(i++);
+
+        if (conv_ == scientific_)
+            write_exp_(p, upper ? 'E' : 'e', exp10_, 2);
+    }
+
+} // namespace ard
@@ -0,0 +1,263 @@
+// Copyright (C) 2019 Vladimir Talybin.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+#include <cmath>
+#include <limits>
+#include <bits/ios_base.hpp>
+#include <bits/bigint.hpp>
+
+namespace ard
+{
+    // Most significant digits a halfway point between two adjacent
+    // values of ValueT can have. The longest are those next to the
+    // smallest subnormals, m * 2^-k with m of digits + 1 bits, which
+    // have log10(m * 5^k) + 1 digits. One more is counted to spare,
+    // it is 769 for double and 114 for float.
+    template <class ValueT>
+    struct halfway_digits
+    {
+        using limits = std::numeric_limits<ValueT>;
+
+        static constexpr int value = int(((limits::digits + 1) * 30103ll +
+            (limits::digits - limits::min_exponent + 1) * 69897ll) / 100000) + 2;
+    };
+
+    // Decimal floating point number as collected by num_get, without
+    // allocation. The value is the integer of the kept digits times
+    // 10^exponent(). Significant digits past N are dropped and only
+    // noted in sticky. With N = halfway_digits<ValueT>::value no
+    // halfway point falls between the kept digits and the value, so
+    // sticky is all rounding needs.
+    template <int N>
+    struct decimal_float
+    {
+        static constexpr int max_digits = N;
+
+        // Digit values, without leading zeros
+        char digits[max_digits];
+        int nd = 0;
+
+        bool negative = false;
+        // A digit of the mantissa is seen
+        bool mantissa = false;
+        // Non-zero digits were dropped
+        bool sticky = false;
+
+    private:
+        int exp10_ = 0;
+        int exp_ = 0;
+        bool exp_negative_ = false;
+
+    public:
+        // Digit d of the mantissa, frac if after the decimal point
+        void add_digit(int d, bool frac)
+        {
+            mantissa = true;
+            if (nd < max_digits) {
+                // Leading zeros of the integer part are not significant
+                if (d || nd)
+                    digits[nd++] = char(d);
+                exp10_ -= frac;
+            }
+            else {
+                sticky |= d != 0;
+                exp10_ += !frac;
+            }
+        }
+
+        void exp_sign(bool neg)
+        { exp_negative_ = neg; }
+
+        // Digit of the exponent, saturated far beyond any value range
+        void add_exp_digit(int d)
+        {
+            if (exp_ < 100000)
+                exp_ = exp_ * 10 + d;
+        }
+
+        int exponent() const
+        { return exp10_ + (exp_negative_ ? -exp_ : exp_); }
+    };
+
+    // Correctly rounded conversion of decimal_float (round half to
+    // even). Exact powers of ten in ValueT give the result directly
+    // for short inputs (Clinger's fast path). Otherwise the quotient
+    // of big integers is divided out bit by bit.
+    template <class ValueT>
+    struct decimal_to_binary
+    {
+        using value_type = ValueT;
+        using limits = std::numeric_limits<value_type>;
+        using decimal_type = decimal_float<halfway_digits<value_type>::value>;
+
+        // Power of ten exact in value_type, 5^k < 2^digits
+        static constexpr int max_exact_pow10 = limits::digits * 1000 / 2322;
+
+        // Decimal exponents below this are zero
+        static constexpr int min_exp10 =
+            limits::min_exponent10 - limits::max_digits10 - 1;
+
+        static bool fast(const decimal_type& d, int e, value_type& v);
+
+        static value_type exact(const decimal_type& d, int e);
+
+    private:
+        // Decimal digits of the quotient bounds the bigint size
+        static constexpr int max_dec_ =
+            (limits::max_exponent10 + 1 > decimal_type::max_digits - min_exp10 ?
+             limits::max_exponent10 + 1 : decimal_type::max_digits - min_exp10);
+        using bigint_type = bigint<(max_dec_ * 3322 / 1000 + limits::digits + 40) / 32>;
+    };
+
+    // Converts d into v as per 22.2.2.1.2 and DR 23. Sets failbit if
+    // there is no mantissa (v = 0) or the value overflows (v = +-max).
+    template <class ValueT>
+    inline void convert_to_v(const typename decimal_to_binary<ValueT>::decimal_type& d,
+                             ValueT& v, ios_base::iostate& err)
+    {
+        using limits = std::numeric_limits<ValueT>;
+        using conv = decimal_to_binary<ValueT>;
+
+        if (!d.mantissa) {
+            v = 0;
+            err = ios_base::failbit;
+            return;
+        }
+
+        const int e = d.exponent();
+        ValueT r;
+        if (!d.nd || d.nd + e < conv::min_exp10)
+            r = 0;
+        else if (d.nd - 1 + e > limits::max_exponent10)
+            r = limits::infinity();
+        else if (!conv::fast(d, e, r))
+            r = conv::exact(d, e);
+
+        if (r > limits::max()) {
+            r = limits::max();
+            err = ios_base::failbit;
+        }
+        v = d.negative ? -r : r;
+    }
+
+
+    //
+    // Methods
+    //
+
+    template <class ValueT>
+    inline bool decimal_to_binary<ValueT>::
+    fast(const decimal_type& d, int e, value_type& v)
+    {
+        // Integers up to 2^digits are exact
+        const unsigned long long max_int = limits::digits < 64 ?
+            1ull << (limits::digits % 64) : ~0ull;
+        if (d.sticky || d.nd > 19)
+            return false;
+
+        unsigned long long w = 0;
+        for (int i = 0; i < d.nd; ++i)
+            w = w * 10 + d.digits[i];
+        if (w > max_int)
+            return false;
+
+        // Move exponent into the integer while it stays exact
+        for (; e > max_exact_pow10 && w <= max_int / 10; --e)
+            w *= 10;
+        if (e > max_exact_pow10 || e < -max_exact_pow10)
+            return false;
+
+        // Both operands are exact, so the result is rounded once
+        value_type p = 1;
+        value_type b = 10;
+        for (int n = e < 0 ? -e : e; n; n >>= 1, b *= b) {
+            if (n & 1)
+                p *= b;
+        }
+        v = e < 0 ? value_type(w) / p : value_type(w) * p;
+        return true;
+    }
+
+    template <class ValueT>
+    inline ValueT decimal_to_binary<ValueT>::
+    exact(const decimal_type& d, int e)
+    {
+        static const uint32_t pow10[] = {
+            1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000
+        };
+
+        // Value is num / den
+        bigint_type num(0);
+        bigint_type den(1);
+        for (int i = 0; i < d.nd; ) {
+            // Nine digits at a time
+            const int n = d.nd - i < 9 ? d.nd - i : 9;
+            uint32_t chunk = 0;
+            for (int j = 0; j < n; ++j)
+                chunk = chunk * 10 + d.digits[i++];
+            num.mul_small(pow10[n]);
+            num.add_small(chunk);
+        }
+        if (e >= 0)
+            num.mul_pow10(e);
+        else
+            den.mul_pow10(-e);
+
+        // Scale into num / den in [1, 2), the value is that times 2^x
+        int x = int(num.bit_length()) - int(den.bit_length());
+        if (x >= 0)
+            den.shl(x);
+        else
+            num.shl(-x);
+        if (num.compare(den) < 0) {
+            num.shl(1);
+            --x;
+        }
+        if (x >= limits::max_exponent)
+            return limits::infinity();
+
+        // Number of mantissa bits, less for subnormals
+        const int emin = limits::min_exponent - 1;
+        const int nb = limits::digits - (x < emin ? emin - x : 0);
+        if (nb < 0)
+            return 0;
+
+        // Long division, up to 32 bits at a time, the first part
+        // taking what is left over. Afterwards num is twice the rest.
+        unsigned long long q = 0;
+        if (nb > 0) {
+            int k = (nb - 1) % 32 + 1;
+            num.shl(k - 1);
+            q = num.div_limb(den);
+            for (int left = nb - k; left > 0; left -= 32) {
+                num.shl(32);
+                q = (q << 32) | num.div_limb(den);
+            }
+            num.shl(1);
+        }
+
+        // Round half to even, num / den is twice the rest. Dropped
+        // digits put a tie above the half.
+        const int c = num.compare(den);
+        if (c > 0 || (c == 0 && (d.sticky || (q & 1)))) {
+            // Carry out of 64 bits is the next power of two
+            if (!++q)
+                return std::ldexp(value_type(1), x + 1);
+        }
+        return std::ldexp(value_type(q), x - nb + 1);
+    }
+
+} // namespace ard
@@ -0,0 +1,148 @@
+// Copyright (C) 2019 Vladimir Talybin.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+#include <stdint.h>
+
+namespace ard
+{
+    // Writes the digits of an unsigned integer right-justified, ending
+    // at the given pointer, and returns the first digit. Two digits are
+    // produced per step: decimal pairs from a table of 00..99, octal
+    // and hexadecimal from six or eight bits at a time. Values wider
+    // than 32 bits are split into 32-bit parts first, so most of the
+    // work uses native division on 32-bit targets.
+    struct int_digits
+    {
+        template <class CharT, class ValueT>
+        static CharT* dec(CharT* p, ValueT v);
+
+        template <class CharT, class ValueT>
+        static CharT* oct(CharT* p, ValueT v);
+
+        template <class CharT, class ValueT>
+        static CharT* hex(CharT* p, ValueT v, bool uppercase);
+
+    private:
+        static const char* pairs_()
+        {
+            static const char pairs[] =
+                "00010203040506070809" "10111213141516171819"
+                "20212223242526272829" "30313233343536373839"
+                "40414243444546474849" "50515253545556575859"
+                "60616263646566676869" "70717273747576777879"
+                "80818283848586878889" "90919293949596979899";
+            return pairs;
+        }
+
+        // Two decimal digits of v < 100 at p
+        template <class CharT>
+        static void pair_(CharT* p, uint32_t v)
+        {
+            const char* d = pairs_() + v * 2;
+            p[0] = CharT(d[0]);
+            p[1] = CharT(d[1]);
+        }
+
+        // Octal digits of v, at least n (even), zero padded
+        template <class CharT>
+        static CharT* oct_(CharT* p, uint32_t v, int n);
+
+        // Hexadecimal digits of v, at least n (even), zero padded
+        template <class CharT>
+        static CharT* hex_(CharT* p, uint32_t v, const char* digits, int n);
+    };
+
+
+    //
+    // Methods
+    //
+
+    template <class CharT, class ValueT>
+    inline CharT* int_digits::dec(CharT* p, ValueT v)
+    {
+        // Eight digits per 64-bit division, the rest in 32 bits
+        unsigned long long w = v;
+        while (w > 0xffffffffu) {
+            const unsigned long long q = w / 100000000;
+            uint32_t r = uint32_t(w - q * 100000000);
+            for (int i = 0; i < 4; ++i, r /= 100)
+                pair_(p -= 2, r % 100);
+            w = q;
+        }
+
+        uint32_t u = uint32_t(w);
+        for (; u >= 100; u /= 100)
+            pair_(p -= 2, u % 100);
+        if (u >= 10)
+            pair_(p -= 2, u);
+        else
+            *--p = CharT('0' + u);
+        return p;
+    }
+
+    template <class CharT, class ValueT>
+    inline CharT* int_digits::oct(CharT* p, ValueT v)
+    {
+        // Ten digits (30 bits) per part
+        unsigned long long w = v;
+        for (; w > 0xffffffffu; w >>= 30)
+            p = oct_(p, uint32_t(w) & 0x3fffffff, 10);
+        p = oct_(p, uint32_t(w), 0);
+        // Drop the leading zero of the last pair
+        return *p == CharT('0') ? p + 1 : p;
+    }
+
+    template <class CharT, class ValueT>
+    inline CharT* int_digits::hex(CharT* p, ValueT v, bool uppercase)
+    {
+        const char* digits = uppercase ? "0123456789ABCDEF" : "0123456789abcdef";
+
+        unsigned long long w = v;
+        for (; w > 0xffffffffu; w >>= 32)
+            p = hex_(p, uint32_t(w), digits, 8);
+        p = hex_(p, uint32_t(w), digits, 0);
+        return *p == CharT('0') ? p + 1 : p;
+    }
+
+    template <class CharT>
+    inline CharT* int_digits::oct_(CharT* p, uint32_t v, int n)
+    {
+        CharT* const end = p;
+        do {
+            p -= 2;
+            p[1] = CharT('0' + (v & 0x7));
+            p[0] = CharT('0' + ((v >> 3) & 0x7));
+            v >>= 6;
+        }
+        while (v || end - p < n);
+        return p;
+    }
+
+    template <class CharT>
+    inline CharT* int_digits::hex_(CharT* p, uint32_t v, const char* digits, int n)
+    {
+        CharT* const end = p;
+        do {
+            p -= 2;
+            p[1] = CharT(digits[v & 0xf]);
+            p[0] = CharT(digits[(v >> 4) & 0xf]);
+            v >>= 8;
+        }
+        while (v || end - p < n);
+        return p;
+    }
+
+} // namespace ard
@@ -0,0 +1,105 @@
+// Copyright (C) 2019 Vladimir Talybin.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+#include <stdint.h>
+
+namespace ard
+{
+    // Parses up to eight octal, decimal or hexadecimal digits at once
+    // within a 64-bit word (SWAR). The characters are validated with
+    // per-byte range checks and folded into a value with three
+    // multiplications, pairing neighbour digits, then pairs, then
+    // quads. The first character is kept in the low byte, whatever
+    // the byte order.
+    struct swar_digits
+    {
+        // Eight characters at p as a word
+        static uint64_t load(const char* p)
+        {
+            uint64_t w = 0;
+            for (int i = 0; i < 8; ++i)
+                w |= uint64_t(static_cast<unsigned char>(p[i])) << (i * 8);
+            return w;
+        }
+
+        // Number of leading characters in w that are digits of base
+        // (8, 10 or 16), their value is returned in v
+        static int parse(uint64_t w, int base, uint32_t& v);
+
+        // base^n for n <= 8
+        static unsigned long long power(int base, int n);
+
+    private:
+        static constexpr uint64_t ones = 0x0101010101010101ull;
+        static constexpr uint64_t high = ones * 0x80;
+
+        // High bit set in the bytes of w within [lo, hi]. Bytes must
+        // be below 0x80, otherwise the carry spoils the bytes after.
+        static uint64_t in_range_(uint64_t w, unsigned char lo, unsigned char hi)
+        { return (w + ones * (0x80 - lo)) & ~(w + ones * (0x7f - hi)) & high; }
+    };
+
+
+    //
+    // Methods
+    //
+
+    inline int swar_digits::parse(uint64_t w, int base, uint32_t& v)
+    {
+        uint64_t ok, d;
+        if (base == 16) {
+            // Letters in lower case, digits are not changed
+            const uint64_t alpha = in_range_(w | ones * 0x20, 'a', 'f');
+            ok = in_range_(w, '0', '9') | alpha;
+            d = (w & ones * 0x0f) + (alpha >> 7) * 9;
+        }
+        else {
+            ok = in_range_(w, '0', base == 8 ? '7' : '9');
+            // Borrow of a non-digit only spoils the bytes after it
+            d = w - ones * '0';
+        }
+        ok &= ~w;
+
+        const uint64_t bad = ~ok & high;
+        const int n = bad ? __builtin_ctzll(bad) / 8 : 8;
+        if (!n) {
+            v = 0;
+            return 0;
+        }
+
+        // Drop the characters after the digits and make room for
+        // leading zeros
+        d <<= (8 - n) * 8;
+
+        const uint64_t b2 = uint64_t(base) * base;
+        d = (d * base + (d >> 8)) & 0x00ff00ff00ff00ffull;
+        d = (d * b2 + (d >> 16)) & 0x0000ffff0000ffffull;
+        d = (d * (b2 * b2) + (d >> 32)) & 0xffffffffull;
+        v = uint32_t(d);
+        return n;
+    }
+
+    inline unsigned long long swar_digits::power(int base, int n)
+    {
+        static const uint32_t pow10[] = {
+            1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000
+        };
+        if (base == 10)
+            return pow10[n];
+        return 1ull << (n * (base == 8 ? 3 : 4));
+    }
+
+} // namespace ard
@@ -0,0 +1,357 @@
+// Copyright (C) 1997-2017 Free Software Foundation, Inc.
+//
+// This file is part of the GNU ISO C++ Library. This library is free
+// software; you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the
+// Free Software Foundation; either version 3, or (at your option)
+// any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// Under Section 7 of GPL version 3, you are granted additional
+// permissions described in the GCC Runtime Library Exception, version
+// 3.1, as published by the Free Software Foundation.
+//
+// You should have received a copy of the GNU General Public License and
+// a copy of the GCC Runtime Library Exception along with this program;
+// see the files COPYING3 and COPYING.RUNTIME respectively. If not, see
+// <http://www.gnu.org/licenses/>.
+
+#pragma once
+#include <limits>
+
+namespace ard
+{
+    // Input shared by basic_istream and static_istream. The stream is
+    // a template parameter, its sentry and rdbuf() are those of the
+    // stream family. Unformatted input counts into gcount.
+
+    // Sentry prefix, skips white space unless noskipws. Sets failbit
+    // and returns false if not good() or there is nothing to extract.
+    template <class IStream>
+    inline bool istream_prefix(IStream& in, bool noskipws)
+    {
+        using traits_type = typename IStream::traits_type;
+
+        ios_base::iostate err = ios_base::goodbit;
+        if (in.good() && !noskipws && (in.flags() & ios_base::skipws)) {
+            if (traits_type::eq_int_type(skip_wsp(in.rdbuf()), traits_type::eof()))
+                err |= ios_base::eofbit;
+        }
+
+        if (in.good() && err == ios_base::goodbit)
+            return true;
+        in.setstate(err | ios_base::failbit);
+        return false;
+    }
+
+    // Parse with pointers into the get area when the token ends before
+    // egptr(), which is the common case for string and buffered
+    // streams. Otherwise nothing is consumed and the iterator path
+    // reads on across buffer refills.
+    template <class IStream, class ValueT>
+    inline void istream_get_num(IStream& in, ValueT& v, ios_base::iostate& err)
+    {
+        using char_type = typename IStream::char_type;
+        using num_get_type = typename IStream::num_get_type;
+        using iter_type = typename num_get_type::iter_type;
+
+        auto* sb = in.rdbuf();
+        const char_type* beg = sb->gptr();
+        const char_type* end = sb->egptr();
+        if (beg != end) {
+            const num_get<char_type, const char_type*> ng;
+            ios_base::iostate e = ios_base::goodbit;
+            const char_type* p = ng.get(beg, end, in, e, v);
+            if (p != end) {
+                sb->gbump(p - beg);
+                err = e;
+                return;
+            }
+        }
+        const num_get_type ng;
+        ng.get(iter_type(sb), iter_type(), in, err, v);
+    }
+
+    template <class IStream, class ValueT>
+    inline IStream& istream_extract_num(IStream& in, ValueT& v)
+    {
+        typename IStream::sentry cerb(in, false);
+        if (cerb) {
+            ios_base::iostate err = ios_base::goodbit;
+            istream_get_num(in, v, err);
+            if (err)
+                in.setstate(err);
+        }
+        return in;
+    }
+
+    // Types narrower than long, extracted as long and range checked
+    template <class IStream, class ValueT>
+    inline IStream& istream_extract_narrow(IStream& in, ValueT& n)
+    {
+        typename IStream::sentry cerb(in, false);
+        if (cerb) {
+            ios_base::iostate err = ios_base::goodbit;
+            long l;
+            istream_get_num(in, l, err);
+
+            if (l < std::numeric_limits<ValueT>::min()) {
+                err |= ios_base::failbit;
+                n = std::numeric_limits<ValueT>::min();
+            }
+            else if (l > std::numeric_limits<ValueT>::max()) {
+                err |= ios_base::failbit;
+                n = std::numeric_limits<ValueT>::max();
+            }
+            else
+                n = ValueT(l);
+
+            if (err)
+                in.setstate(err);
+        }
+        return in;
+    }
+
+    template <class IStream>
+    inline IStream& istream_extract_char(IStream& in, typename IStream::char_type& c)
+    {
+        using traits_type = typename IStream::traits_type;
+
+        typename IStream::sentry cerb(in, false);
+        if (cerb) {
+            const auto cb = in.rdbuf()->sbumpc();
+            if (!traits_type::eq_int_type(cb, traits_type::eof()))
+                c = traits_type::to_char_type(cb);
+            else
+                in.setstate(ios_base::eofbit | ios_base::failbit);
+        }
+        return in;
+    }
+
+    // Skips white space regardless of skipws
+    template <class IStream>
+    inline IStream& istream_ws(IStream& in)
+    {
+        using traits_type = typename IStream::traits_type;
+
+        if (traits_type::eq_int_type(skip_wsp(in.rdbuf()), traits_type::eof()))
+            in.setstate(ios_base::eofbit);
+        return in;
+    }
+
+    template <class IStream>
+    inline typename IStream::int_type
+    istream_get(IStream& in, std::streamsize& gcount)
+    {
+        using traits_type = typename IStream::traits_type;
+        using int_type = typename IStream::int_type;
+
+        const int_type eof = traits_type::eof();
+        int_type c = eof;
+        gcount = 0;
+        ios_base::iostate err = ios_base::goodbit;
+
+        typename IStream::sentry cerb(in, true);
+        if (cerb) {
+            c = in.rdbuf()->sbumpc();
+            // 27.6.1.1 paragraph 3
+            if (!traits_type::eq_int_type(c, eof))
+                gcount = 1;
+            else
+                err |= ios_base::eofbit;
+        }
+        if (!gcount)
+            err |= ios_base::failbit;
+        if (err)
+            in.setstate(err);
+        return c;
+    }
+
+    template <class IStream>
+    inline IStream&
+    istream_get(IStream& in, typename IStream::char_type& c, std::streamsize& gcount)
+    {
+        using traits_type = typename IStream::traits_type;
+
+        const auto cb = istream_get(in, gcount);
+        if (!traits_type::eq_int_type(cb, traits_type::eof()))
+            c = traits_type::to_char_type(cb);
+        return in;
+    }
+
+    template <class IStream>
+    inline typename IStream::int_type
+    istream_peek(IStream& in, std::streamsize& gcount)
+    {
+        using traits_type = typename IStream::traits_type;
+        using int_type = typename IStream::int_type;
+
+        int_type c = traits_type::eof();
+        gcount = 0;
+        typename IStream::sentry cerb(in, true);
+        if (cerb) {
+            c = in.rdbuf()->sgetc();
+            if (traits_type::eq_int_type(c, traits_type::eof()))
+                in.setstate(ios_base::eofbit);
+        }
+        return c;
+    }
+
+    template <class IStream>
+    inline IStream&
+    istream_read(IStream& in, typename IStream::char_type* s, std::streamsize n,
+                 std::streamsize& gcount)
+    {
+        gcount = 0;
+        typename IStream::sentry cerb(in, true);
+        if (cerb) {
+            gcount = in.rdbuf()->sgetn(s, n);
+            if (gcount != n)
+                in.setstate(ios_base::eofbit | ios_base::failbit);
+        }
+        return in;
+    }
+
+    // One character
+    template <class IStream>
+    inline IStream& istream_ignore(IStream& in, std::streamsize& gcount)
+    {
+        using traits_type = typename IStream::traits_type;
+
+        gcount = 0;
+        typename IStream::sentry cerb(in, true);
+        if (cerb) {
+            if (traits_type::eq_int_type(in.rdbuf()->sbumpc(), traits_type::eof()))
+                in.setstate(ios_base::eofbit);
+            else
+                gcount = 1;
+        }
+        return in;
+    }
+
+    // Up to n characters, all of them for the maximum of streamsize.
+    // gcount is negative while it counts past the maximum.
+    template <class IStream>
+    inline IStream& istream_ignore(IStream& in, std::streamsize n, std::streamsize& gcount)
+    {
+        using traits_type = typename IStream::traits_type;
+        using int_type = typename IStream::int_type;
+
+        gcount = 0;
+        typename IStream::sentry cerb(in, true);
+        if (n > 0 && cerb) {
+            const int_type eof = traits_type::eof();
+            auto* sb = in.rdbuf();
+            int_type c = sb->sgetc();
+
+            bool large_ignore = false;
+            while (true) {
+                while (gcount < n && !traits_type::eq_int_type(c, eof)) {
+                    // All of the get area at once, if there is one
+                    const std::streamsize size = std::min(
+                        std::streamsize(sb->egptr() - sb->gptr()),
+                        gcount < 0 ? n : n - gcount);
+                    if (size > 1) {
+                        sb->sgetconsume(size);
+                        gcount += size;
+                        c = sb->sgetc();
+                    }
+                    else {
+                        ++gcount;
+                        c = sb->snextc();
+                    }
+                }
+                if (n == std::numeric_limits<std::streamsize>::max() &&
+                    !traits_type::eq_int_type(c, eof))
+                {
+                    gcount = std::numeric_limits<std::streamsize>::min();
+                    large_ignore = true;
+                }
+                else break;
+            }
+
+            if (large_ignore)
+                gcount = std::numeric_limits<std::streamsize>::max();
+
+            if (traits_type::eq_int_type(c, eof))
+                in.setstate(ios_base::eofbit);
+        }
+        return in;
+    }
+
+    // Up to n characters or through delim
+    template <class IStream>
+    inline IStream& istream_ignore(IStream& in, std::streamsize n,
+                                   typename IStream::int_type delim, std::streamsize& gcount)
+    {
+        using char_type = typename IStream::char_type;
+        using traits_type = typename IStream::traits_type;
+        using int_type = typename IStream::int_type;
+
+        if (traits_type::eq_int_type(delim, traits_type::eof()))
+            return istream_ignore(in, n, gcount);
+
+        gcount = 0;
+        typename IStream::sentry cerb(in, true);
+        if (n > 0 && cerb) {
+            const int_type eof = traits_type::eof();
+            auto* sb = in.rdbuf();
+            int_type c = sb->sgetc();
+            // A delim outside of the character range never matches
+            const char_type cdelim = traits_type::to_char_type(delim);
+            const bool testdelim = traits_type::eq_int_type(
+                traits_type::to_int_type(cdelim), delim);
+
+            bool large_ignore = false;
+            while (true) {
+                while (gcount < n &&
+                       !traits_type::eq_int_type(c, eof) &&
+                       !traits_type::eq_int_type(c, delim))
+                {
+                    // Up to delim in the get area at once
+                    std::streamsize size = std::min(
+                        std::streamsize(sb->egptr() - sb->gptr()),
+                        gcount < 0 ? n : n - gcount);
+                    if (size > 1) {
+                        if (testdelim)
+                            size = find_char(sb->gptr() + 1, sb->gptr() + size, cdelim)
+                                - sb->gptr();
+                        sb->sgetconsume(size);
+                        gcount += size;
+                        c = sb->sgetc();
+                    }
+                    else {
+                        ++gcount;
+                        c = sb->snextc();
+                    }
+                }
+                if (n == std::numeric_limits<std::streamsize>::max() &&
+                    !traits_type::eq_int_type(c, eof) &&
+                    !traits_type::eq_int_type(c, delim))
+                {
+                    gcount = std::numeric_limits<std::streamsize>::min();
+                    large_ignore = true;
+                }
+                else break;
+            }
+
+            if (large_ignore)
+                gcount = std::numeric_limits<std::streamsize>::max();
+
+            // A delim right after the n-th character is left unread
+            if (traits_type::eq_int_type(c, eof))
+                in.setstate(ios_base::eofbit);
+            else if (traits_type::eq_int_type(c, delim) && (large_ignore || gcount < n)) {
+                if (gcount < std::numeric_limits<std::streamsize>::max())
+                    ++gcount;
+                sb->sbumpc();
+            }
+        }
+        return in;
+    }
+
+} // namespace ard
@@ -21,6 +21,11 @@
 // <http://www.gnu.org/licenses/>.
 
 #pragma once
+#include <bits/char_scan.hpp>
+#include <bits/float_format.hpp>
+#include <bits/float_parse.hpp>
+#include <bits/int_format.hpp>
+#include <bits/int_parse.hpp>
 
 // Locale is not supported by this implementation.
 // Extracting required minimum.
@@ -37,7 +42,7 @@ namespace ard
         { return c; }
 
         static bool is_wsp(char c)
-        { return std::isspace(c); }
+        { return ard::is_wsp(c); }
 
         static const char* truename()
         { return "true"; }
@@ -122,13 +127,31 @@ namespace ard
         { return this->do_get(in, end, io, err, v); }
 
     protected:
+        template <int N>
         iter_type extract_float_(
-            iter_type, iter_type, ios_base&, ios_base::iostate&, std::string&) const;
+            iter_type, iter_type, ios_base&, ios_base::iostate&, decimal_float<N>&) const;
 
         template <class ValueT>
         iter_type extract_int_(
             iter_type, iter_type, ios_base&, ios_base::iostate&, ValueT&) const;
 
+        // Leading digits of base from contiguous characters, up to
+        // eight at once. Returns the number of digits consumed or -1
+        // if it does not apply (other iterators, the end is near, or
+        // words narrower than 32 bits where the scalar loop is faster).
+        static int extract_digits_(const char*& beg, const char* end, int base, uint32_t& v)
+        {
+            if (sizeof(int) < 4 || end - beg < 8)
+                return -1;
+            const int n = swar_digits::parse(swar_digits::load(beg), base, v);
+            beg += n;
+            return n;
+        }
+
+        template <class Iter>
+        static int extract_digits_(Iter&, Iter, int, uint32_t&)
+        { return -1; }
+
         // Numeric parsing
 
         virtual iter_type
@@ -213,6 +236,10 @@ namespace ard
 
         // Format the floating point value and insert it into a stream
 
+        // Extension, float is formatted in single precision arithmetic
+        iter_type put(iter_type s, ios_base& io, char_type fill, float v) const
+        { return this->do_put(s, io, fill, v); }
+
         iter_type put(iter_type s, ios_base& io, char_type fill, double v) const
         { return this->do_put(s, io, fill, v); }
 
@@ -226,7 +253,7 @@ namespace ard
     protected:
         template <class ValueT>
         iter_type insert_float_(
-            iter_type, ios_base& io, char_type fill, char mod, ValueT v) const;
+            iter_type, ios_base& io, char_type fill, ValueT v) const;
 
         template <class ValueT>
         iter_type insert_int_(
@@ -235,6 +262,58 @@ namespace ard
         void pad_(char_type fill, std::streamsize w, ios_base& io,
                   char_type* n, const char_type* cs, int& len) const;
 
+        // Number of leading characters of cs that go before the padding
+        static int pad_pos_(ios_base& io, const char_type* cs, int len);
+
+        // Writes n fill characters, in place when s has room for them
+        static iter_type fill_(iter_type s, char_type fill, std::streamsize n);
+
+        // Stage 4, writes cs padded to width w
+        iter_type put_padded_(iter_type s, ios_base& io, char_type fill,
+                              std::streamsize w, const char_type* cs, int len) const;
+
+        // Room for n characters in the put area when s writes to
+        // a stream buffer that has it (s has reserve_()), nullptr
+        // otherwise
+        template <class Iter>
+        static char_type* reserve_(Iter& s, std::streamsize n)
+        { return reserve_(s, n, 0); }
+
+        template <class Iter>
+        static auto reserve_(Iter& s, std::streamsize n, int) -> decltype(s.reserve_(n))
+        { return s.reserve_(n); }
+
+        template <class Iter>
+        static char_type* reserve_(Iter&, std::streamsize, long)
+        { return nullptr; }
+
+        template <class Iter>
+        static void commit_(Iter& s, std::streamsize n)
+        { commit_(s, n, 0); }
+
+        template <class Iter>
+        static auto commit_(Iter& s, std::streamsize n, int) -> decltype(s.commit_(n))
+        { s.commit_(n); }
+
+        template <class Iter>
+        static void commit_(Iter&, std::streamsize, long)
+        { }
+
+        // Writes cs of n characters, with one sputn() when s writes
+        // to a stream buffer (s has put_())
+        template <class Iter>
+        static Iter write_(Iter s, const char_type* cs, std::streamsize n)
+        { return write_(s, cs, n, 0); }
+
+        template <class Iter>
+        static auto write_(Iter s, const char_type* cs, std::streamsize n, int)
+            -> decltype(s.put_(cs, n), Iter(s))
+        { return s.put_(cs, n); }
+
+        template <class Iter>
+        static Iter write_(Iter s, const char_type* cs, std::streamsize n, long)
+        { return std::copy_n(cs, n, s); }
+
         // These functions do the work of formatting numeric values and
         // inserting them into a stream. This function is a hook for derived
         // classes to change the value returned
@@ -258,6 +337,9 @@ namespace ard
         do_put(iter_type s, ios_base& io, char_type fill, unsigned long long v) const
         { return insert_int_(s, io, fill, v); }
 
+        virtual iter_type
+        do_put(iter_type, ios_base&, char_type, float) const;
+
         virtual iter_type
         do_put(iter_type, ios_base&, char_type, double) const;
 
@@ -274,9 +356,10 @@ namespace ard
     //
 
     template <class CharT, class InIter>
+    template <int N>
     inline InIter num_get<CharT, InIter>::
     extract_float_(InIter beg, InIter end, ios_base& io,
-                   ios_base::iostate& err, std::string& xtrc) const
+                   ios_base::iostate& err, decimal_float<N>& xtrc) const
     {
         using ct = ctype<CharT>;
 
@@ -294,7 +377,7 @@ namespace ard
             c = *beg;
             const bool is_plus = c == plus;
             if (is_plus || c == minus) {
-                xtrc += is_plus ? '+' : '-';
+                xtrc.negative = !is_plus;
                 if (++beg != end)
                     c = *beg;
                 else
@@ -307,7 +390,7 @@ namespace ard
         int sep_pos = 0;
         while (!testeof && c == zero) {
             if (!found_mantissa) {
-                xtrc += '0';
+                xtrc.add_digit(0, false);
                 found_mantissa = true;
             }
             ++sep_pos;
@@ -325,18 +408,19 @@ namespace ard
         while (!testeof) {
             const int digit = ct::digit(c);
             if (digit >= 0 && digit <= 9) {
-                xtrc += '0' + digit;
+                if (found_sci)
+                    xtrc.add_exp_digit(digit);
+                else
+                    xtrc.add_digit(digit, found_dec);
                 found_mantissa = true;
             }
             else if (c == dec_point && !found_dec && !found_sci) {
-                xtrc += '.';
                 found_dec = true;
             }
             else if ((c == ct::widen('e') || c == ct::widen('E')) &&
                     !found_sci && found_mantissa)
             {
                 // Scientific notation
-                xtrc += 'e';
                 found_sci = true;
 
                 // Remove optional plus or minus sign, if they exist
@@ -344,7 +428,7 @@ namespace ard
                     c = *beg;
                     const bool is_plus = c == plus;
                     if (is_plus || c == minus)
-                        xtrc += is_plus ? '+' : '-';
+                        xtrc.exp_sign(!is_plus);
                     else
                         continue;
                 }
@@ -441,6 +525,28 @@ namespace ard
         bool testoverflow = false;
 
         while (!testeof) {
+            // Blocks of digits, same overflow rule as below
+            uint32_t block;
+            const int n = extract_digits_(beg, end, base, block);
+            if (n >= 0) {
+                if (!testoverflow) {
+                    unsigned long long r;
+                    testoverflow =
+                        __builtin_mul_overflow(result, swar_digits::power(base, n), &r) ||
+                        __builtin_add_overflow(r, block, &r) || r > max;
+                    result = unsigned_type(r);
+                }
+                sep_pos += n;
+                if (beg == end)
+                    testeof = true;
+                else
+                    c = *beg;
+                // Stopped at a non-digit
+                if (n < 8)
+                    break;
+                continue;
+            }
+
             const int digit = ct::digit(c);
             // Only allow base digits as valid input
             if (digit < 0 || digit >= base)
@@ -545,10 +651,9 @@ namespace ard
     do_get(iter_type beg, iter_type end, ios_base& io,
            ios_base::iostate& err, float& v) const
     {
-        std::string xtrc;
-        xtrc.reserve(32);
+        typename decimal_to_binary<float>::decimal_type xtrc;
         beg = extract_float_(beg, end, io, err, xtrc);
-        v = strtof(xtrc.c_str(), nullptr);
+        convert_to_v(xtrc, v, err);
         if (beg == end)
             err |= ios_base::eofbit;
         return beg;
@@ -559,10 +664,9 @@ namespace ard
     do_get(iter_type beg, iter_type end, ios_base& io,
            ios_base::iostate& err, double& v) const
     {
-        std::string xtrc;
-        xtrc.reserve(32);
+        typename decimal_to_binary<double>::decimal_type xtrc;
         beg = extract_float_(beg, end, io, err, xtrc);
-        v = strtod(xtrc.c_str(), nullptr);
+        convert_to_v(xtrc, v, err);
         if (beg == end)
             err |= ios_base::eofbit;
         return beg;
@@ -573,10 +677,9 @@ namespace ard
     do_get(iter_type beg, iter_type end, ios_base& io,
            ios_base::iostate& err, long double& v) const
     {
-        std::string xtrc;
-        xtrc.reserve(32);
+        typename decimal_to_binary<long double>::decimal_type xtrc;
         beg = extract_float_(beg, end, io, err, xtrc);
-        v = strtold(xtrc.c_str(), nullptr);
+        convert_to_v(xtrc, v, err);
         if (beg == end)
             err |= ios_base::eofbit;
         return beg;
@@ -619,44 +722,91 @@ namespace ard
          CharT* news, const CharT* olds, int& len) const
     {
         using traits_type = std::char_traits<CharT>;
-        using ct = ctype<CharT>;
 
-        std::streamsize oldlen = len;
-        const size_t plen = static_cast<size_t>(newlen - oldlen);
-        const ios_base::fmtflags adjust = io.flags() & ios_base::adjustfield;
+        const int pos = pad_pos_(io, olds, len);
+        const size_t plen = static_cast<size_t>(newlen - len);
 
+        traits_type::copy(news, olds, pos);
+        traits_type::assign(news + pos, plen, fill);
+        traits_type::copy(news + pos + plen, olds + pos, len - pos);
         len = static_cast<int>(newlen);
+    }
+
+    template <class CharT, class OutIter>
+    inline int num_put<CharT, OutIter>::
+    pad_pos_(ios_base& io, const CharT* cs, int len)
+    {
+        using ct = ctype<CharT>;
+
+        const ios_base::fmtflags adjust = io.flags() & ios_base::adjustfield;
 
         // Padding last
-        if (adjust == ios_base::left) {
-            traits_type::copy(news, olds, oldlen);
-            traits_type::assign(news + oldlen, plen, fill);
-            return;
-        }
+        if (adjust == ios_base::left)
+            return len;
 
-        size_t mod = 0;
         if (adjust == ios_base::internal) {
             // Pad after the sign, if there is one.
             // Pad after 0[xX], if there is one.
             // Who came up with these rules, anyway? Jeeze.
-            if (ct::widen('-') == olds[0] || ct::widen('+') == olds[0]) {
-                news[0] = olds[0];
-                mod = 1;
-                ++news;
-            }
-            else if (ct::widen('0') == olds[0]
-                    && oldlen > 1
-                    && (ct::widen('x') == olds[1] || ct::widen('X') == olds[1]))
+            if (ct::widen('-') == cs[0] || ct::widen('+') == cs[0])
+                return 1;
+            if (ct::widen('0') == cs[0]
+                && len > 1
+                && (ct::widen('x') == cs[1] || ct::widen('X') == cs[1]))
             {
-                news[0] = olds[0];
-                news[1] = olds[1];
-                mod = 2;
-                news += 2;
+                return 2;
             }
-            // else Padding first
         }
-        traits_type::assign(news, plen, fill);
-        traits_type::copy(news + plen, olds + mod, oldlen - mod);
+        // Padding first
+        return 0;
+    }
+
+    template <class CharT, class OutIter>
+    inline OutIter num_put<CharT, OutIter>::
+    fill_(OutIter s, CharT fill, std::streamsize n)
+    {
+        using traits_type = std::char_traits<CharT>;
+
+        if (char_type* p = reserve_(s, n)) {
+            traits_type::assign(p, n, fill);
+            commit_(s, n);
+            return s;
+        }
+
+        // In chunks, as ostream_fill()
+        char_type chunk[16];
+        traits_type::assign(chunk, std::min<std::streamsize>(n, 16), fill);
+        for (; n > 0; n -= 16)
+            s = write_(s, chunk, std::min<std::streamsize>(n, 16));
+        return s;
+    }
+
+    // Written directly into the put area when it has room, otherwise
+    // through the iterator with the padding around the value
+    template <class CharT, class OutIter>
+    inline OutIter num_put<CharT, OutIter>::
+    put_padded_(OutIter s, ios_base& io, CharT fill,
+                std::streamsize w, const CharT* cs, int len) const
+    {
+        using traits_type = std::char_traits<CharT>;
+
+        const bool pad = w > static_cast<std::streamsize>(len);
+        if (char_type* p = reserve_(s, pad ? w : len)) {
+            if (pad)
+                pad_(fill, w, io, p, cs, len);
+            else
+                traits_type::copy(p, cs, len);
+            commit_(s, len);
+            return s;
+        }
+
+        if (pad) {
+            const int pos = pad_pos_(io, cs, len);
+            s = write_(s, cs, pos);
+            s = fill_(s, fill, w - len);
+            return write_(s, cs + pos, len - pos);
+        }
+        return write_(s, cs, len);
     }
 
     // Non-member
@@ -669,31 +819,25 @@ namespace ard
         CharT* buf = bufend;
 
         if (dec) {
-            // Decimal
-            do {
-                *--buf = zero + (v % 10);
-                v /= 10;
+            // Decimal, in pairs unless int is 16 bits where the
+            // table of pairs would take RAM
+            if (sizeof(int) >= 4)
+                buf = int_digits::dec(buf, v);
+            else {
+                do {
+                    *--buf = zero + (v % 10);
+                    v /= 10;
+                }
+                while (v != 0);
             }
-            while (v != 0);
         }
         else if ((flags & ios_base::basefield) == ios_base::oct) {
             // Octal
-            do {
-                *--buf = zero + (v & 0x7);
-                v >>= 3;
-            }
-            while (v != 0);
+            buf = int_digits::oct(buf, v);
         }
         else {
             // Hex
-            const bool uppercase = flags & ios_base::uppercase;
-            const CharT alpha = ct::widen("aA"[uppercase]);
-            do {
-                int nibble = v & 0xf;
-                *--buf = nibble + (nibble < 10 ? zero : (alpha - 10));
-                v >>= 4;
-            }
-            while (v != 0);
+            buf = int_digits::hex(buf, v, flags & ios_base::uppercase);
         }
         return bufend - buf;
     }
@@ -754,94 +898,43 @@ namespace ard
 
         // Pad
         const std::streamsize w = io.width();
-        char_type cs3[w];
-        if (w > static_cast<std::streamsize>(len)) {
-            pad_(fill, w, io, cs3, cs, len);
-            cs = cs3;
-        }
         io.width(0);
 
         // [22.2.2.2.2] Stage 4.
         // Write resulting, fully-formatted string to output iterator.
-        return std::copy_n(cs, len, s);
+        return put_padded_(s, io, fill, w, cs, len);
     }
 
-    // Non-member
-    inline void format_float(const ios_base& io, char* fptr, char mod)
-    {
-        ios_base::fmtflags flags = io.flags();
-        *fptr++ = '%';
-        // [22.2.2.2.2] Table 60
-        if (flags & ios_base::showpos)
-            *fptr++ = '+';
-        if (flags & ios_base::showpoint)
-            *fptr++ = '#';
-
-        ios_base::fmtflags fltfield = flags & ios_base::floatfield;
-
-        // Precision is always used except for hexfloat format.
-        if (fltfield != (ios_base::fixed | ios_base::scientific))
-        {
-            // As per DR 231: not only when flags & ios_base::fixed || prec > 0
-            *fptr++ = '.';
-            *fptr++ = '*';
-        }
-
-        if (mod)
-            *fptr++ = mod;
-        // [22.2.2.2.2] Table 58
-        if (fltfield == ios_base::fixed)
-            *fptr++ = 'f';
-        else if (fltfield == ios_base::scientific)
-            *fptr++ = (flags & ios_base::uppercase) ? 'E' : 'e';
-        else if (fltfield == (ios_base::fixed | ios_base::scientific))
-            *fptr++ = (flags & ios_base::uppercase) ? 'A' : 'a';
-        else
-            *fptr++ = (flags & ios_base::uppercase) ? 'G' : 'g';
-        *fptr = '\0';
-    }
-
-    // The following code uses vsnprintf (or vsprintf(), when
-    // _GLIBCXX_USE_C99_STDIO is not defined) to convert floating point
-    // values for insertion into a stream. An optimization would be to
-    // replace them with code that works directly on a wide buffer and
-    // then use pad to do the padding. It would be good to replace
-    // them anyway to gain back the efficiency that C++ provides by
-    // knowing up front the type of the values to insert. Also, sprintf
-    // is dangerous since may lead to accidental buffer overruns.  This
-    // implementation follows the C++ standard fairly directly as
+    // Floating point values are converted by float_decimal instead
+    // of snprintf, which is both slow and large on small targets.
+    // This implementation follows the C++ standard fairly directly as
     // outlined in 22.2.2.2 [lib.locale.num.put]
     template <class CharT, class OutIter>
     template <class ValueT>
     inline OutIter num_put<CharT, OutIter>::
-    insert_float_(OutIter s, ios_base& io, CharT fill, char mod, ValueT v) const
+    insert_float_(OutIter s, ios_base& io, CharT fill, ValueT v) const
     {
-        // Use default precision if out of range
-        const std::streamsize prec = io.precision() < 0 ? 6 : io.precision();
-
         // [22.2.2.2.2] Stage 1, numeric conversion to character.
-        int len;
-        // Long enough for the max format spec.
-        char fbuf[16];
-        format_float(io, fbuf, mod);
-
-        // Precision is always used except for hexfloat format.
-        const bool use_prec =
-            (io.flags() & ios_base::floatfield) != ios_base::floatfield;
-
-        // First determine the size of buffer needed
-        if (use_prec)
-            len = snprintf(nullptr, 0, fbuf, prec, v);
-        else
-            len = snprintf(nullptr, 0, fbuf, v);
+        // Precision is ignored for hexfloat format.
+        float_decimal<ValueT> fd(v, io.flags(), io.precision());
+        char digits[fd.digits_size()];
+        fd.generate(digits);
 
-        // Now convert to string
-        int cs_size = len + 1;
-        char cs[cs_size];
-        if (use_prec)
-            len = snprintf(cs, cs_size, fbuf, prec, v);
-        else
-            len = snprintf(cs, cs_size, fbuf, v);
+        const int len = fd.length();
+        const std::streamsize w = io.width();
+        io.width(0);
+
+        // Without padding the result goes straight to the put area
+        if (w <= static_cast<std::streamsize>(len)) {
+            if (char_type* p = reserve_(s, len)) {
+                fd.format(p);
+                commit_(s, len);
+                return s;
+            }
+        }
+
+        char cs[len];
+        fd.format(cs);
 
         // [22.2.2.2.2] Stage 2, convert to char_type, using correct
         // numpunct.decimal_point() values for '.' and adding grouping.
@@ -852,20 +945,10 @@ namespace ard
         // point, scientific notation.
         // Skipping, no locale implemented...
 
-        // Pad
-        const std::streamsize w = io.width();
-        char_type ws3[w];
-        char* ws = cs;
-        if (w > static_cast<std::streamsize>(len)) {
-            pad_(fill, w, io, ws3, ws, len);
-            ws = ws3;
-        }
-        io.width(0);
-
-        // [22.2.2.2.2] Stage 4.
-        // Write resulting, fully-formatted string to output iterator.
-        return std::copy_n(ws, len, s);
-      }
+        // [22.2.2.2.2] Stage 3 and 4, pad and write resulting,
+        // fully-formatted string to output iterator.
+        return put_padded_(s, io, fill, w, cs, len);
+    }
 
     template <class CharT, class OutIter>
     inline OutIter num_put<CharT, OutIter>::
@@ -883,40 +966,29 @@ namespace ard
 
             const char_type* name =
                 v ? ct::truename() : ct::falsename();
-            int len = traits_type::length(name);
+            const int len = traits_type::length(name);
 
             const std::streamsize w = io.width();
-            if (w > static_cast<std::streamsize>(len)) {
-                const std::streamsize plen = w - len;
-                char_type ps[plen];
-
-                traits_type::assign(ps, plen, fill);
-                io.width(0);
-                if ((flags & ios_base::adjustfield) == ios_base::left) {
-                    s = std::copy_n(name, len, s);
-                    s = std::copy_n(ps, plen, s);
-                }
-                else {
-                    s = std::copy_n(ps, plen, s);
-                    s = std::copy_n(name, len, s);
-                }
-                return s;
-            }
             io.width(0);
-            s = std::copy_n(name, len, s);
+            s = put_padded_(s, io, fill, w, name, len);
         }
         return s;
     }
 
+    template <class CharT, class OutIter>
+    inline OutIter num_put<CharT, OutIter>::
+    do_put(iter_type s, ios_base& io, char_type fill, float v) const
+    { return insert_float_(s, io, fill, v); }
+
     template <class CharT, class OutIter>
     inline OutIter num_put<CharT, OutIter>::
     do_put(iter_type s, ios_base& io, char_type fill, double v) const
-    { return insert_float_(s, io, fill, char(), v); }
+    { return insert_float_(s, io, fill, v); }
 
     template <class CharT, class OutIter>
     inline OutIter num_put<CharT, OutIter>::
     do_put(iter_type s, ios_base& io, char_type fill, long double v) const
-    { return insert_float_(s, io, fill, 'L', v); }
+    { return insert_float_(s, io, fill, v); }
 
     template <class CharT, class OutIter>
     inline OutIter num_put<CharT, OutIter>::
@@ -24,63 +24,150 @@
 
 namespace ard
 {
-    template<typename CharT, typename Traits>
-    inline void
-    ostream_write(basic_ostream<CharT, Traits>& out,
-		          const CharT* s, std::streamsize n)
+    // Output shared by basic_ostream and static_ostream. The stream is
+    // a template parameter, its sentry and rdbuf() are those of the
+    // stream family.
+
+    // Sentry prefix, sets failbit and returns false if not good()
+    template <class OStream>
+    inline bool ostream_prefix(OStream& out)
     {
-        using ostream_type = basic_ostream<CharT, Traits>;
-        using ios_base = typename ostream_type::ios_base;
+        if (out.good())
+            return true;
+        out.setstate(ios_base::failbit);
+        return false;
+    }
 
-        const std::streamsize put = out.rdbuf()->sputn(s, n);
+    // Sentry suffix, flushes with unitbuf
+    template <class OStream>
+    inline void ostream_unitbuf(OStream& out)
+    {
+        // Can't call flush directly or else will get into recursive lock
+        if ((out.flags() & ios_base::unitbuf) &&
+            out.rdbuf() && out.rdbuf()->pubsync() == -1)
+        {
+            out.setstate(ios_base::badbit);
+        }
+    }
+
+    template <class OStream>
+    inline void
+    ostream_write(OStream& out, const typename OStream::char_type* s, std::streamsize n)
+    {
+        // A single character that fits the put area goes through the
+        // inline sputc(). Otherwise sputn() writes it, so a device
+        // without a buffer still gets one write(s, n).
+        auto* sb = out.rdbuf();
+        if (n == 1 && sb->pptr() < sb->epptr()) {
+            sb->sputc(*s);
+            return;
+        }
+        const std::streamsize put = sb->sputn(s, n);
         if (put != n)
-	        out.setstate(ios_base::badbit);
+            out.setstate(ios_base::badbit);
     }
 
-    template<typename CharT, typename Traits>
+    template <class OStream>
     inline void
-    ostream_fill(basic_ostream<CharT, Traits>& out, std::streamsize n)
+    ostream_fill(OStream& out, std::streamsize n)
     {
-        using ostream_type = basic_ostream<CharT, Traits>;
-        using ios_base = typename ostream_type::ios_base;
-
-        const CharT c = out.fill();
-        for (; n > 0; --n) {
-	        const typename Traits::int_type put = out.rdbuf()->sputc(c);
-	        if (Traits::eq_int_type(put, Traits::eof())) {
-	            out.setstate(ios_base::badbit);
-	            break;
-	        }
-	    }
+        using char_type = typename OStream::char_type;
+        using traits_type = typename OStream::traits_type;
+
+        if (n <= 0)
+            return;
+
+        // Straight into the put area, otherwise in chunks
+        const char_type c = out.fill();
+        if (char_type* p = out.rdbuf()->sputreserve(n)) {
+            traits_type::assign(p, n, c);
+            out.rdbuf()->sputcommit(n);
+            return;
+        }
+
+        char_type chunk[16];
+        traits_type::assign(chunk, std::min<std::streamsize>(n, 16), c);
+        for (; n > 0; n -= 16) {
+            const std::streamsize len = std::min<std::streamsize>(n, 16);
+            if (out.rdbuf()->sputn(chunk, len) != len) {
+                out.setstate(ios_base::badbit);
+                break;
+            }
+        }
     }
 
-    template<typename CharT, typename Traits>
-    inline basic_ostream<CharT, Traits>&
-    ostream_insert(basic_ostream<CharT, Traits>& out,
-		           const CharT* s, std::streamsize n)
+    // Characters s of n padded to width()
+    template <class OStream>
+    inline OStream&
+    ostream_insert(OStream& out, const typename OStream::char_type* s, std::streamsize n)
     {
-        using ostream_type = basic_ostream<CharT, Traits>;
-        using ios_base = typename ostream_type::ios_base;
+        using char_type = typename OStream::char_type;
+        using traits_type = typename OStream::traits_type;
 
-        typename ostream_type::sentry cerb(out);
+        typename OStream::sentry cerb(out);
         if (cerb) {
-	        const std::streamsize w = out.width();
-	        if (w > n) {
-		        const bool left =
+            const std::streamsize w = out.width();
+            if (w > n) {
+                const bool left =
                     ((out.flags() & ios_base::adjustfield) == ios_base::left);
-		        if (!left)
-		            ostream_fill(out, w - n);
-		        if (out.good())
-		            ostream_write(out, s, n);
-		        if (left && out.good())
-		            ostream_fill(out, w - n);
-		    }
-	        else
-		        ostream_write(out, s, n);
-	        out.width(0);
-	    }
+                // Padded in place when the put area has room
+                if (char_type* p = out.rdbuf()->sputreserve(w)) {
+                    traits_type::assign(left ? p + n : p, w - n, out.fill());
+                    traits_type::copy(left ? p : p + (w - n), s, n);
+                    out.rdbuf()->sputcommit(w);
+                }
+                else {
+                    if (!left)
+                        ostream_fill(out, w - n);
+                    if (out.good())
+                        ostream_write(out, s, n);
+                    if (left && out.good())
+                        ostream_fill(out, w - n);
+                }
+            }
+            else
+                ostream_write(out, s, n);
+            out.width(0);
+        }
         return out;
     }
 
-} // namespace ard
+    // Numbers, bool and pointers, formatted by num_put
+    template <class OStream, class ValueT>
+    inline OStream&
+    ostream_insert_num(OStream& out, ValueT v)
+    {
+        using num_put_type = typename OStream::num_put_type;
+        using iter_type = typename num_put_type::iter_type;
 
+        typename OStream::sentry cerb(out);
+        if (cerb) {
+            const num_put_type np;
+            if (np.put(iter_type(out.rdbuf()), out, out.fill(), v).failed())
+                out.setstate(ios_base::badbit);
+        }
+        return out;
+    }
+
+    template <class OStream>
+    inline OStream&
+    ostream_put(OStream& out, typename OStream::char_type c)
+    {
+        using traits_type = typename OStream::traits_type;
+
+        typename OStream::sentry cerb(out);
+        if (cerb && traits_type::eq_int_type(out.rdbuf()->sputc(c), traits_type::eof()))
+            out.setstate(ios_base::badbit);
+        return out;
+    }
+
+    template <class OStream>
+    inline OStream&
+    ostream_flush(OStream& out)
+    {
+        if (out.rdbuf() && out.rdbuf()->pubsync() == -1)
+            out.setstate(ios_base::badbit);
+        return out;
+    }
+
+} // namespace ard
@@ -0,0 +1,90 @@
+// Copyright (C) 2019 Vladimir Talybin.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+#include <stddef.h>
+#include <type_traits>
+
+namespace ard
+{
+    // Non-owning view of a contiguous sequence of T, a subset of
+    // std::span with dynamic extent only
+    template <class T>
+    struct span
+    {
+        using element_type = T;
+        using value_type = typename std::remove_cv<T>::type;
+        using size_type = size_t;
+        using pointer = T*;
+        using reference = T&;
+        using iterator = T*;
+
+    private:
+        pointer data_ = nullptr;
+        size_type size_ = 0;
+
+    public:
+        constexpr span() noexcept = default;
+
+        constexpr span(pointer p, size_type n) noexcept
+        : data_(p)
+        , size_(n)
+        { }
+
+        constexpr span(pointer first, pointer last) noexcept
+        : data_(first)
+        , size_(last - first)
+        { }
+
+        template <size_t N>
+        constexpr span(element_type (&arr)[N]) noexcept
+        : data_(arr)
+        , size_(N)
+        { }
+
+        // span<const T> from span<T>
+        template <class U, class = typename std::enable_if<
+            std::is_convertible<U(*)[], T(*)[]>::value>::type>
+        constexpr span(const span<U>& s) noexcept
+        : data_(s.data())
+        , size_(s.size())
+        { }
+
+        constexpr pointer data() const noexcept
+        { return data_; }
+
+        constexpr size_type size() const noexcept
+        { return size_; }
+
+        constexpr bool empty() const noexcept
+        { return size_ == 0; }
+
+        constexpr iterator begin() const noexcept
+        { return data_; }
+
+        constexpr iterator end() const noexcept
+        { return data_ + size_; }
+
+        constexpr reference operator[](size_type i) const
+        { return data_[i]; }
+
+        constexpr span first(size_type n) const
+        { return span(data_, n); }
+
+        constexpr span subspan(size_type off) const
+        { return span(data_ + off, size_ - off); }
+    };
+
+} // namespace ard
@@ -194,6 +194,14 @@ namespace ard
                 failed_ = true;
             return *this;
         }
+
+        // Room for len characters in the put area, nullptr if there
+        // is none or output failed
+        char_type* reserve_(std::streamsize len)
+        { return failed_ ? nullptr : sbuf_->sputreserve(len); }
+
+        void commit_(std::streamsize len)
+        { sbuf_->sputcommit(len); }
     };
 
 } // namespace ard
@@ -0,0 +1,149 @@
+// Copyright (C) 2019 Vladimir Talybin.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+#include <algorithm>
+#include <string>
+
+namespace ard
+{
+    // Non-owning view of a character sequence, a subset of
+    // std::basic_string_view for C++14
+    template <class CharT, class Traits = std::char_traits<CharT>>
+    struct basic_string_view
+    {
+        using char_type = CharT;
+        using traits_type = Traits;
+        using value_type = CharT;
+        using size_type = size_t;
+        using const_pointer = const CharT*;
+        using const_iterator = const CharT*;
+
+        static constexpr size_type npos = size_type(-1);
+
+    private:
+        const_pointer data_ = nullptr;
+        size_type size_ = 0;
+
+    public:
+        constexpr basic_string_view() noexcept = default;
+
+        constexpr basic_string_view(const_pointer s, size_type n) noexcept
+        : data_(s)
+        , size_(n)
+        { }
+
+        basic_string_view(const_pointer s)
+        : data_(s)
+        , size_(traits_type::length(s))
+        { }
+
+        template <class Alloc>
+        basic_string_view(const std::basic_string<CharT, Traits, Alloc>& s) noexcept
+        : data_(s.data())
+        , size_(s.size())
+        { }
+
+        // Copy of the characters
+        template <class Alloc = std::allocator<CharT>>
+        std::basic_string<CharT, Traits, Alloc> to_string() const
+        { return std::basic_string<CharT, Traits, Alloc>(data_, size_); }
+
+        explicit operator std::basic_string<CharT, Traits>() const
+        { return this->to_string(); }
+
+        constexpr const_pointer data() const noexcept
+        { return data_; }
+
+        constexpr size_type size() const noexcept
+        { return size_; }
+
+        constexpr size_type length() const noexcept
+        { return size_; }
+
+        constexpr bool empty() const noexcept
+        { return size_ == 0; }
+
+        constexpr const_iterator begin() const noexcept
+        { return data_; }
+
+        constexpr const_iterator end() const noexcept
+        { return data_ + size_; }
+
+        constexpr const CharT& operator[](size_type i) const
+        { return data_[i]; }
+
+        constexpr const CharT& front() const
+        { return data_[0]; }
+
+        constexpr const CharT& back() const
+        { return data_[size_ - 1]; }
+
+        void remove_prefix(size_type n)
+        {
+            data_ += n;
+            size_ -= n;
+        }
+
+        void remove_suffix(size_type n)
+        { size_ -= n; }
+
+        // No exceptions, pos is clamped to size()
+        basic_string_view substr(size_type pos = 0, size_type n = npos) const
+        {
+            pos = std::min(pos, size_);
+            return basic_string_view(data_ + pos, std::min(n, size_ - pos));
+        }
+
+        int compare(basic_string_view v) const
+        {
+            const int ret = traits_type::compare(data_, v.data_, std::min(size_, v.size_));
+            if (ret)
+                return ret;
+            return size_ < v.size_ ? -1 : size_ > v.size_;
+        }
+
+        size_type find(CharT c, size_type pos = 0) const
+        {
+            if (pos >= size_)
+                return npos;
+            const CharT* p = traits_type::find(data_ + pos, size_ - pos, c);
+            return p ? size_type(p - data_) : npos;
+        }
+
+        bool starts_with(basic_string_view v) const
+        { return size_ >= v.size_ && traits_type::compare(data_, v.data_, v.size_) == 0; }
+
+        friend bool operator==(basic_string_view a, basic_string_view b)
+        { return a.size_ == b.size_ && a.compare(b) == 0; }
+
+        friend bool operator!=(basic_string_view a, basic_string_view b)
+        { return !(a == b); }
+
+        friend bool operator<(basic_string_view a, basic_string_view b)
+        { return a.compare(b) < 0; }
+    };
+
+    template <class CharT, class Traits>
+    constexpr typename basic_string_view<CharT, Traits>::size_type
+    basic_string_view<CharT, Traits>::npos;
+
+    //
+    // Alias
+    //
+
+    using string_view = basic_string_view<char>;
+
+} // namespace ard
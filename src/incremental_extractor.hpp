@@ -0,0 +1,210 @@
+// Copyright (C) 2019 Vladimir Talybin.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+#include <istream.hpp>
+
+namespace ard
+{
+    // State of an incremental_extractor
+    enum class extract_state
+    {
+        pending,    // Token is not complete yet, feed more input
+        done,       // Value is extracted
+        failed      // Token is not a valid value
+    };
+
+    // Extracts a single value from input that arrives in parts.
+    // Characters of the token are collected in an internal buffer
+    // of at most N characters and parsed once a character that
+    // does not belong to the token arrives (or on finish()). That
+    // character is left unconsumed in the input. Format flags
+    // (basefield, boolalpha, skipws) are taken from the ios_base.
+    template <class ValueT, size_t N = 32,
+              class CharT = char, class Traits = std::char_traits<CharT>>
+    struct incremental_extractor : ios_base
+    {
+        using value_type = ValueT;
+        using char_type = CharT;
+        using traits_type = Traits;
+
+        using int_type = typename traits_type::int_type;
+        using istream_type = basic_istream<char_type, traits_type>;
+        using streambuf_type = basic_streambuf<char_type, traits_type>;
+
+    private:
+        // num_get has no int and short overloads, parse them as long
+        using parse_type = std::conditional_t<
+            std::is_same<value_type, int>::value ||
+            std::is_same<value_type, short>::value, long, value_type>;
+
+        // One extra character to tell a too long token from
+        // a token of N characters
+        char_type buf_[N + 1];
+        size_t len_ = 0;
+        extract_state state_ = extract_state::pending;
+        value_type value_ = value_type();
+
+    public:
+        incremental_extractor()
+        { }
+
+        // Feed the characters in [first, last). Returns pointer to the
+        // first character not consumed, that is last while the token
+        // is pending.
+        const char_type* feed(const char_type* first, const char_type* last);
+
+        // Feed what is available in the stream without blocking.
+        // Uses in_avail() of the stream buffer.
+        extract_state feed(istream_type& is);
+
+        // End of input. Parse the collected characters as they are.
+        extract_state finish();
+
+        // Start over with the next token, flags are kept
+        void reset()
+        {
+            len_ = 0;
+            state_ = extract_state::pending;
+            value_ = value_type();
+        }
+
+        extract_state state() const
+        { return state_; }
+
+        // Extracted value, valid when state() is done. Set as by
+        // num_get (zero or the clamped limit) when failed.
+        const value_type& value() const
+        { return value_; }
+
+    private:
+        // Parse the collected characters. Returns the end of the token.
+        const char_type* parse_(ios_base::iostate& err);
+
+        void finalize_(ios_base::iostate err)
+        {
+            state_ = (err & ios_base::failbit) ?
+                extract_state::failed : extract_state::done;
+        }
+    };
+
+
+    //
+    // Methods
+    //
+
+    template <class ValueT, size_t N, class CharT, class Traits>
+    inline const CharT* incremental_extractor<ValueT, N, CharT, Traits>::
+    parse_(ios_base::iostate& err)
+    {
+        const num_get<char_type, const char_type*> ng;
+        parse_type v = parse_type();
+        const char_type* p = ng.get(buf_, buf_ + len_, *this, err, v);
+
+        if (!std::is_same<parse_type, value_type>::value) {
+            if (v < std::numeric_limits<value_type>::min()) {
+                err |= ios_base::failbit;
+                v = std::numeric_limits<value_type>::min();
+            }
+            else if (v > std::numeric_limits<value_type>::max()) {
+                err |= ios_base::failbit;
+                v = std::numeric_limits<value_type>::max();
+            }
+        }
+        value_ = value_type(v);
+        return p;
+    }
+
+    template <class ValueT, size_t N, class CharT, class Traits>
+    inline const CharT* incremental_extractor<ValueT, N, CharT, Traits>::
+    feed(const char_type* first, const char_type* last)
+    {
+        if (state_ != extract_state::pending)
+            return first;
+
+        // Skip leading white space
+        if (!len_ && (this->flags() & ios_base::skipws)) {
+            while (first != last && ctype<char_type>::is_wsp(*first))
+                ++first;
+        }
+        if (first == last)
+            return first;
+
+        // Append what fits and parse everything collected so far.
+        // The parser is restarted from the beginning of the token,
+        // which is at most N characters.
+        const size_t n = std::min<size_t>(last - first, N + 1 - len_);
+        const char_type* tok = buf_ + len_;
+        traits_type::copy(buf_ + len_, first, n);
+        len_ += n;
+
+        ios_base::iostate err = ios_base::goodbit;
+        const char_type* p = parse_(err);
+
+        if (p != buf_ + len_) {
+            // Token ended within the new characters
+            len_ = p - buf_;
+            finalize_(err);
+            return first + (p - tok);
+        }
+
+        // Too long to be a valid value
+        if (len_ > N)
+            state_ = extract_state::failed;
+        return first + n;
+    }
+
+    template <class ValueT, size_t N, class CharT, class Traits>
+    inline extract_state incremental_extractor<ValueT, N, CharT, Traits>::
+    feed(istream_type& is)
+    {
+        streambuf_type* sb = is.rdbuf();
+        if (!sb)
+            return state_;
+
+        while (state_ == extract_state::pending && sb->in_avail() > 0) {
+            if (sb->gptr() < sb->egptr()) {
+                // Parse directly from the get area
+                const char_type* p = feed(sb->gptr(), sb->egptr());
+                sb->gbump(p - sb->gptr());
+            }
+            else {
+                // Unbuffered, one character at a time
+                const int_type c = sb->sgetc();
+                if (traits_type::eq_int_type(c, traits_type::eof()))
+                    break;
+
+                const char_type ch = traits_type::to_char_type(c);
+                if (feed(&ch, &ch + 1) == &ch)
+                    break;
+                sb->sbumpc();
+            }
+        }
+        return state_;
+    }
+
+    template <class ValueT, size_t N, class CharT, class Traits>
+    inline extract_state incremental_extractor<ValueT, N, CharT, Traits>::
+    finish()
+    {
+        if (state_ == extract_state::pending) {
+            ios_base::iostate err = ios_base::goodbit;
+            parse_(err);
+            finalize_(err);
+        }
+        return state_;
+    }
+
+} // namespace ard
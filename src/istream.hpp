@@ -22,6 +22,7 @@
 
 #pragma once
 #include <ios.hpp>
+#include <bits/istream_extract.hpp>
 
 namespace ard
 {
@@ -87,12 +88,13 @@ namespace ard
         { return extract_(n); }
 
         istream_type& operator>>(short& n)
-        { return extract_(n); }
+        { return istream_extract_narrow(*this, n); }
 
         istream_type& operator>>(unsigned short& n)
         { return extract_(n); }
 
-        istream_type& operator>>(int& n);
+        istream_type& operator>>(int& n)
+        { return istream_extract_narrow(*this, n); }
 
         istream_type& operator>>(unsigned int& n)
         { return extract_(n); }
@@ -141,10 +143,12 @@ namespace ard
         { return gcount_; }
 
         // Simple extraction
-        int_type get();
+        int_type get()
+        { return istream_get(*this, gcount_); }
 
         // Simple extraction
-        istream_type& get(char_type& c);
+        istream_type& get(char_type& c)
+        { return istream_get(*this, c, gcount_); }
 
         // Simple multiple-character extraction
         istream_type& get(char_type* s, std::streamsize n, char_type delim);
@@ -168,15 +172,22 @@ namespace ard
         { return this->getline(s, n, traits_type::widen('\n')); }
 
         // Discarding characters
-        istream_type& ignore(std::streamsize n, int_type delim);
-        istream_type& ignore(std::streamsize n);
-        istream_type& ignore();
+        istream_type& ignore(std::streamsize n, int_type delim)
+        { return istream_ignore(*this, n, delim, gcount_); }
+
+        istream_type& ignore(std::streamsize n)
+        { return istream_ignore(*this, n, gcount_); }
+
+        istream_type& ignore()
+        { return istream_ignore(*this, gcount_); }
 
         // Looking ahead in the stream
-        int_type peek();
+        int_type peek()
+        { return istream_peek(*this, gcount_); }
 
         // Extraction without delimiters
-        istream_type& read(char_type* s, std::streamsize n);
+        istream_type& read(char_type* s, std::streamsize n)
+        { return istream_read(*this, s, n, gcount_); }
 
         // Extraction until the buffer is exhausted, but no more
         std::streamsize readsome(char_type* s, std::streamsize n);
@@ -228,7 +239,8 @@ namespace ard
         }
 
         template <class ValueT>
-        istream_type& extract_(ValueT& v);
+        istream_type& extract_(ValueT& v)
+        { return istream_extract_num(*this, v); }
     };
 
 
@@ -247,27 +259,13 @@ namespace ard
         // The constructor performs all the work
         explicit sentry(istream_type& is, bool noskipws = false)
         {
-            ios_base::iostate err = ios_base::goodbit;
-            if (is.good()) {
-                if (is.tie())
-                    is.tie()->flush();
-                if (!noskipws && (is.flags() & ios_base::skipws)) {
-                    const int_type eof = traits_type::eof();
-                    streambuf_type* sb = is.rdbuf();
-                    int_type c = sb->sgetc();
-
-                    while (ct::is_wsp(c))
-                        c = sb->snextc();
-
-                    if (traits_type::eq_int_type(c, eof))
-                        err |= ios_base::eofbit;
-                }
+            // Only with output waiting, pubsync() may be costly
+            if (is.good() && is.tie() && is.tie()->rdbuf() &&
+                is.tie()->rdbuf()->sputwaiting())
+            {
+                is.tie()->flush();
             }
-
-            if (is.good() && err == ios_base::goodbit)
-                ok_ = true;
-            else
-                is.setstate(err | ios_base::failbit);
+            ok_ = istream_prefix(is, noskipws);
         }
 
         // Quick status checking
@@ -279,48 +277,6 @@ namespace ard
     };
 
 
-    template <class CharT, class Traits>
-    template <class ValueT>
-    inline basic_istream<CharT, Traits>& basic_istream<CharT, Traits>::
-    extract_(ValueT& v)
-    {
-        sentry cerb(*this, false);
-        if (cerb) {
-            ios_base::iostate err = ios_base::goodbit;
-            this->num_get_.get(*this, 0, *this, err, v);
-            if (err)
-                this->setstate(err);
-        }
-        return *this;
-    }
-
-    template <class CharT, class Traits>
-    inline basic_istream<CharT, Traits>&
-    basic_istream<CharT, Traits>::operator>>(int& n)
-    {
-        sentry cerb(*this, false);
-        if (cerb) {
-            ios_base::iostate err = ios_base::goodbit;
-            long l;
-            this->num_get_.get(*this, 0, *this, err, l);
-
-            if (l < std::numeric_limits<int>::min()) {
-                err |= ios_base::failbit;
-                n = std::numeric_limits<int>::min();
-            }
-            else if (l > std::numeric_limits<int>::max()) {
-                err |= ios_base::failbit;
-                n = std::numeric_limits<int>::max();
-            }
-            else
-                n = int(l);
-
-            if (err)
-                this->setstate(err);
-        }
-        return *this;
-    }
-
     template <class CharT, class Traits>
     inline basic_istream<CharT, Traits>&
     basic_istream<CharT, Traits>::operator>>(streambuf_type* sbout)
@@ -341,56 +297,6 @@ namespace ard
         return *this;
     }
 
-    template <class CharT, class Traits>
-    inline typename basic_istream<CharT, Traits>::int_type
-    basic_istream<CharT, Traits>::get()
-    {
-        const int_type eof = traits_type::eof();
-        int_type c = eof;
-        gcount_ = 0;
-        ios_base::iostate err = ios_base::goodbit;
-
-        sentry cerb(*this, true);
-        if (cerb) {
-            c = this->rdbuf()->sbumpc();
-            // 27.6.1.1 paragraph 3
-            if (!traits_type::eq_int_type(c, eof))
-                gcount_ = 1;
-            else
-                err |= ios_base::eofbit;
-        }
-        if (!gcount_)
-            err |= ios_base::failbit;
-        if (err)
-            this->setstate(err);
-        return c;
-    }
-
-    template <class CharT, class Traits>
-    inline basic_istream<CharT, Traits>&
-    basic_istream<CharT, Traits>::get(char_type& c)
-    {
-        gcount_ = 0;
-        ios_base::iostate err = ios_base::goodbit;
-
-        sentry cerb(*this, true);
-        if (cerb) {
-            const int_type cb = this->rdbuf()->sbumpc();
-            // 27.6.1.1 paragraph 3
-            if (!traits_type::eq_int_type(cb, traits_type::eof())) {
-                gcount_ = 1;
-                c = traits_type::to_char_type(cb);
-            }
-            else
-                err |= ios_base::eofbit;
-        }
-        if (!gcount_)
-            err |= ios_base::failbit;
-        if (err)
-            this->setstate(err);
-        return *this;
-    }
-
     template <class CharT, class Traits>
     inline basic_istream<CharT, Traits>&
     basic_istream<CharT, Traits>::get(char_type* s, std::streamsize n, char_type delim)
@@ -499,151 +405,6 @@ namespace ard
         return *this;
     }
 
-    template <class CharT, class Traits>
-    inline basic_istream<CharT, Traits>& basic_istream<CharT, Traits>::
-    ignore()
-    {
-        gcount_ = 0;
-        sentry cerb(*this, true);
-        if (cerb) {
-            ios_base::iostate err = ios_base::goodbit;
-            const int_type eof = traits_type::eof();
-            streambuf_type* sb = this->rdbuf();
-
-            if (traits_type::eq_int_type(sb->sbumpc(), eof))
-                err |= ios_base::eofbit;
-            else
-                gcount_ = 1;
-
-            if (err)
-                this->setstate(err);
-        }
-        return *this;
-    }
-
-    template <class CharT, class Traits>
-    inline basic_istream<CharT, Traits>& basic_istream<CharT, Traits>::
-    ignore(std::streamsize n)
-    {
-        gcount_ = 0;
-        sentry cerb(*this, true);
-        if (n > 0 && cerb) {
-            ios_base::iostate err = ios_base::goodbit;
-            const int_type eof = traits_type::eof();
-            streambuf_type* sb = this->rdbuf();
-            int_type c = sb->sgetc();
-
-            bool large_ignore = false;
-            while (true) {
-                while (gcount_ < n && !traits_type::eq_int_type(c, eof)) {
-                    ++gcount_;
-                    c = sb->snextc();
-                }
-                if (n == std::numeric_limits<std::streamsize>::max() &&
-                    !traits_type::eq_int_type(c, eof))
-                {
-                    gcount_ = std::numeric_limits<std::streamsize>::min();
-                    large_ignore = true;
-                }
-                else break;
-            }
-
-            if (large_ignore)
-                gcount_ = std::numeric_limits<std::streamsize>::max();
-
-            if (traits_type::eq_int_type(c, eof))
-                err |= ios_base::eofbit;
-            if (err)
-                this->setstate(err);
-        }
-        return *this;
-    }
-
-    template <class CharT, class Traits>
-    inline basic_istream<CharT, Traits>& basic_istream<CharT, Traits>::
-    ignore(std::streamsize n, int_type delim)
-    {
-        if (traits_type::eq_int_type(delim, traits_type::eof()))
-            return ignore(n);
-
-        gcount_ = 0;
-        sentry cerb(*this, true);
-        if (n > 0 && cerb) {
-            ios_base::iostate err = ios_base::goodbit;
-            const int_type eof = traits_type::eof();
-            streambuf_type* sb = this->rdbuf();
-            int_type c = sb->sgetc();
-
-            bool large_ignore = false;
-            while (true) {
-                while (gcount_ < n &&
-                       !traits_type::eq_int_type(c, eof) &&
-                       !traits_type::eq_int_type(c, delim))
-                {
-                    ++gcount_;
-                    c = sb->snextc();
-                }
-                if (n == std::numeric_limits<std::streamsize>::max() &&
-                    !traits_type::eq_int_type(c, eof) &&
-                    !traits_type::eq_int_type(c, delim))
-                {
-                    gcount_ = std::numeric_limits<std::streamsize>::min();
-                    large_ignore = true;
-                }
-                else break;
-            }
-
-            if (large_ignore)
-                gcount_ = std::numeric_limits<std::streamsize>::max();
-
-            if (traits_type::eq_int_type(c, eof))
-                err |= ios_base::eofbit;
-            else if (traits_type::eq_int_type(c, delim)) {
-                if (gcount_ < std::numeric_limits<std::streamsize>::max())
-                    ++gcount_;
-                sb->sbumpc();
-            }
-            if (err)
-                this->setstate(err);
-        }
-        return *this;
-    }
-
-    template <class CharT, class Traits>
-    inline typename basic_istream<CharT, Traits>::int_type
-    basic_istream<CharT, Traits>::peek()
-    {
-        int_type c = traits_type::eof();
-        gcount_ = 0;
-        sentry cerb(*this, true);
-        if (cerb) {
-            ios_base::iostate err = ios_base::goodbit;
-            c = this->rdbuf()->sgetc();
-            if (traits_type::eq_int_type(c, traits_type::eof()))
-                err |= ios_base::eofbit;
-            if (err)
-                this->setstate(err);
-        }
-        return c;
-    }
-
-    template <class CharT, class Traits>
-    inline basic_istream<CharT, Traits>&
-    basic_istream<CharT, Traits>::read(char_type* s, std::streamsize n)
-    {
-        gcount_ = 0;
-        sentry cerb(*this, true);
-        if (cerb) {
-            ios_base::iostate err = ios_base::goodbit;
-            gcount_ = this->rdbuf()->sgetn(s, n);
-            if (gcount_ != n)
-                err |= (ios_base::eofbit | ios_base::failbit);
-            if (err)
-                this->setstate(err);
-        }
-        return *this;
-    }
-
     template <class CharT, class Traits>
     inline std::streamsize
     basic_istream<CharT, Traits>::readsome(char_type* s, std::streamsize n)
@@ -795,24 +556,7 @@ namespace ard
     template <class CharT, class Traits>
     inline basic_istream<CharT, Traits>&
     operator>>(basic_istream<CharT, Traits>& in, CharT& c)
-    {
-        using istream_type = basic_istream<CharT, Traits>;
-        using int_type = typename istream_type::int_type;
-
-        typename istream_type::sentry cerb(in, false);
-        if (cerb) {
-            ios_base::iostate err = ios_base::goodbit;
-            const int_type cb = in.rdbuf()->sbumpc();
-
-            if (!Traits::eq_int_type(cb, Traits::eof()))
-                c = Traits::to_char_type(cb);
-            else
-                err |= (ios_base::eofbit | ios_base::failbit);
-            if (err)
-                in.setstate(err);
-        }
-        return in;
-    }
+    { return istream_extract_char(in, c); }
 
     inline basic_istream<char>&
     operator>>(basic_istream<char>& in, unsigned char& c)
@@ -877,25 +621,7 @@ namespace ard
     template <class CharT, class Traits>
     inline basic_istream<CharT, Traits>&
     ws(basic_istream<CharT, Traits>& in)
-    {
-        using char_type = CharT;
-        using traits_type = Traits;
-
-        using streambuf_type = basic_streambuf<char_type, traits_type>;
-        using int_type = typename traits_type::int_type;
-        using ct = ctype<char_type>;
-
-        const int_type eof = traits_type::eof();
-        streambuf_type* sb = in.rdbuf();
-        int_type c = sb->sgetc();
-
-        while (ct::is_wsp(c))
-            c = sb->snextc();
-
-        if (traits_type::eq_int_type(c, eof))
-            in.setstate(ios_base::eofbit);
-        return in;
-    }
+    { return istream_ws(in); }
 
     // Explicit specialization declarations
     inline basic_istream<char>&
@@ -943,8 +669,7 @@ namespace ard
                     std::streamsize(sb->egptr()- sb->gptr()),
                     std::streamsize(n - extracted));
                 if (size > 1) {
-                    size = std::find_if(
-                            sb->gptr() + 1, sb->gptr() + size, ct::is_wsp)
+                    size = find_wsp(sb->gptr() + 1, sb->gptr() + size)
                         - sb->gptr();
                     str.append(sb->gptr(), size);
                     sb->gbump(size);
@@ -1000,10 +725,8 @@ namespace ard
                     std::streamsize(sb->egptr() - sb->gptr()),
                     std::streamsize(n - extracted));
                 if (size > 1) {
-                    const char* p = traits_type::find(
-                        sb->gptr(), size, delim);
-                    if (p)
-                        size = p - sb->gptr();
+                    size = find_char(sb->gptr(), sb->gptr() + size, delim)
+                        - sb->gptr();
                     str.append(sb->gptr(), size);
                     sb->gbump(size);
                     extracted += size;
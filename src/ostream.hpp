@@ -23,6 +23,7 @@
 #pragma once
 #include <ios.hpp>
 #include <bits/ostream_insert.hpp>
+#include <bits/string_view.hpp>
 
 namespace ard
 {
@@ -57,6 +58,10 @@ namespace ard
         struct sentry;
         friend struct sentry;
 
+        // Does the sentry work once for a group of insertions
+        struct batch;
+        friend struct batch;
+
         // Interface for manipulators
         ostream_type& operator<<(ostream_type& (*pf)(ostream_type&))
         { return pf(*this); }
@@ -107,8 +112,9 @@ namespace ard
         ostream_type& operator<<(double f)
         { return insert_(f); }
 
+        // Formatted as float, without promotion to double
         ostream_type& operator<<(float f)
-        { return insert_(static_cast<double>(f)); }
+        { return insert_(f); }
 
         ostream_type& operator<<(long double f)
         { return insert_(f); }
@@ -129,11 +135,7 @@ namespace ard
 
         // Core write functionality, without sentry
         void write_(const char_type* s, std::streamsize n)
-        {
-	        const std::streamsize put = this->rdbuf()->sputn(s, n);
-	        if (put != n)
-	            this->setstate(ios_base::badbit);
-        }
+        { ostream_write(*this, s, n); }
 
         // Character string insertion
         ostream_type& write(const char_type* s, std::streamsize n);
@@ -178,6 +180,9 @@ namespace ard
 
         template <class ValueT>
 	    ostream_type& insert_(ValueT v);
+
+        // Number of batch objects alive
+        int batch_depth_ = 0;
     };
 
     // Performs setup work for output streams
@@ -189,23 +194,21 @@ namespace ard
         : ok_(false)
         , os_(os)
         {
-            if (os.tie() && os.good())
+            // A batch has flushed the tied stream already. It is only
+            // flushed with output waiting, pubsync() may be costly.
+            if (!os.batch_depth_ && os.tie() && os.good() &&
+                os.tie()->rdbuf() && os.tie()->rdbuf()->sputwaiting())
+            {
                 os.tie()->flush();
-
-            if (os.good())
-                ok_ = true;
-            else
-                os.setstate(ios_base::failbit);
+            }
+            ok_ = ostream_prefix(os);
         }
 
         // Possibly flushes the stream
         ~sentry()
         {
-	        if (os_.flags() & ios_base::unitbuf) {
-	            // Can't call flush directly or else will get into recursive lock
-	            if (os_.rdbuf() && os_.rdbuf()->pubsync() == -1)
-	                os_.setstate(ios_base::badbit);
-	        }
+            if (!os_.batch_depth_)
+                ostream_unitbuf(os_);
         }
 
         // Quick status checking
@@ -217,6 +220,39 @@ namespace ard
         basic_ostream<CharT, Traits>& os_;
     };
 
+    // Flushes tie() once at the start and, with unitbuf, the stream
+    // once at the end of its scope. Insertions meanwhile skip both,
+    // the state they leave is the same as without a batch.
+    //
+    // {
+    //     ard::ostream::batch b(out);
+    //     out << a << ' ' << b << '\n';
+    // }
+    //
+    template <typename CharT, typename Traits>
+    struct basic_ostream<CharT, Traits>::batch
+    {
+        explicit batch(basic_ostream<CharT, Traits>& os)
+        : cerb_(os)
+        , os_(os)
+        { ++os_.batch_depth_; }
+
+        // Unitbuf is handled by cerb_, after the count is down
+        ~batch()
+        { --os_.batch_depth_; }
+
+        batch(const batch&) = delete;
+        batch& operator=(const batch&) = delete;
+
+        // Whether the stream was good at the start
+        explicit operator bool() const
+        { return bool(cerb_); }
+
+    private:
+        sentry cerb_;
+        basic_ostream<CharT, Traits>& os_;
+    };
+
     // Character inserters
     template <class CharT, class Traits>
     inline basic_ostream<CharT, Traits>&
@@ -307,18 +343,7 @@ namespace ard
     template <class ValueT>
     inline basic_ostream<CharT, Traits>& basic_ostream<CharT, Traits>::
     insert_(ValueT v)
-    {
-        sentry cerb(*this);
-        if (cerb) {
-            ios_base::iostate err = ios_base::goodbit;
-            if (this->num_put_.put(*this, *this, this->fill(), v).failed()) {
-                err |= ios_base::badbit;
-            }
-            if (err)
-                this->setstate(err);
-        }
-        return *this;
-    }
+    { return ostream_insert_num(*this, v); }
     
     template <class CharT, class Traits>
     inline basic_ostream<CharT, Traits>& basic_ostream<CharT, Traits>::
@@ -362,18 +387,7 @@ namespace ard
     template <class CharT, class Traits>
     inline basic_ostream<CharT, Traits>& basic_ostream<CharT, Traits>::
     put(char_type c)
-    {
-        sentry cerb(*this);
-        if (cerb) {
-            ios_base::iostate err = ios_base::goodbit;
-            const int_type p = this->rdbuf()->sputc(c);
-            if (traits_type::eq_int_type(p, traits_type::eof()))
-                err |= ios_base::badbit;
-            if (err)
-                this->setstate(err);
-        }
-        return *this;
-    }
+    { return ostream_put(*this, c); }
 
     template <class CharT, class Traits>
     inline basic_ostream<CharT, Traits>& basic_ostream<CharT, Traits>::
@@ -388,14 +402,7 @@ namespace ard
     template <class CharT, class Traits>
     inline basic_ostream<CharT, Traits>& basic_ostream<CharT, Traits>::
     flush()
-    {
-        ios_base::iostate err = ios_base::goodbit;
-        if (this->rdbuf() && this->rdbuf()->pubsync() == -1)
-            err |= ios_base::badbit;
-        if (err)
-            this->setstate(err);
-        return *this;
-    }
+    { return ostream_flush(*this); }
 
     template <class CharT, class Traits>
     inline typename basic_ostream<CharT, Traits>::pos_type
@@ -472,6 +479,14 @@ namespace ard
         return ostream_insert(out, str.data(), str.size());
     }
 
+    template <class CharT, class Traits>
+    inline basic_ostream<CharT, Traits>&
+    operator<<(basic_ostream<CharT, Traits>& out,
+               basic_string_view<CharT, Traits> str)
+    {
+        return ostream_insert(out, str.data(), str.size());
+    }
+
     //
     // Alias
     //
@@ -0,0 +1,278 @@
+// Copyright (C) 2019 Vladimir Talybin.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+#include <atomic>
+#include <ostream.hpp>
+
+namespace ard
+{
+    // What basic_ringbuf does with output that does not fit
+    enum class ring_overflow
+    {
+        drop_newest,    // Discard the characters being written
+        drop_oldest     // Discard the oldest unread characters
+    };
+
+    // Output stream buffer over a fixed ring of N characters, for one
+    // producer (writing through the streambuf, e.g. from an interrupt
+    // handler) and one consumer (calling drain(), e.g. from loop()).
+    // Writing never blocks nor allocates. Characters that do not fit
+    // are dropped according to the policy and counted in dropped().
+    //
+    // With drop_newest the producer is wait-free. With drop_oldest
+    // it may need to retry advancing the read position while the
+    // consumer drains, and the consumer copies each span out before
+    // committing it, since the producer may overwrite it meanwhile.
+    template <size_t N, class CharT, class Traits = std::char_traits<CharT>>
+    struct basic_ringbuf : basic_streambuf<CharT, Traits>
+    {
+        static_assert(N && !(N & (N - 1)), "ring size must be a power of two");
+
+        using char_type = CharT;
+        using traits_type = Traits;
+
+        using int_type = typename traits_type::int_type;
+        using streambuf_type = basic_streambuf<char_type, traits_type>;
+
+    protected:
+        // Characters copied at a time when draining with drop_oldest
+        static constexpr size_t chunk_size = N < 32 ? N : 32;
+        static constexpr size_t mask = N - 1;
+
+        const ring_overflow policy_;
+        char_type ring_[N];
+
+        // Free running positions, the index is position & mask.
+        // Head is written by the producer only, tail by the consumer
+        // and, with drop_oldest, the producer.
+        std::atomic<size_t> head_;
+        std::atomic<size_t> tail_;
+        std::atomic<size_t> dropped_;
+
+    public:
+        explicit basic_ringbuf(ring_overflow policy = ring_overflow::drop_newest)
+        : policy_(policy)
+        , head_(0)
+        , tail_(0)
+        , dropped_(0)
+        { }
+
+        ring_overflow policy() const
+        { return policy_; }
+
+        // Characters waiting to be drained
+        size_t size() const
+        { return head_.load(std::memory_order_acquire) -
+                 tail_.load(std::memory_order_acquire); }
+
+        static constexpr size_t capacity()
+        { return N; }
+
+        // Characters dropped because the ring was full. With
+        // drop_oldest also those drained but not taken by the sink.
+        size_t dropped() const
+        { return dropped_.load(std::memory_order_relaxed); }
+
+        // Consumer side. Write the pending characters to the stream
+        // buffer or to a device with write(const uint8_t*, size_t),
+        // such as ::Stream. Returns the number of characters written.
+        size_t drain(streambuf_type* sb)
+        { return sb ? drain_(sb) : 0; }
+
+        template <class Device,
+                  class = std::enable_if_t<!std::is_pointer<Device>::value>>
+        size_t drain(Device& dev)
+        { return drain_(dev); }
+
+    protected:
+        // Output is not reported as failed when dropped
+        virtual int_type overflow(int_type c = traits_type::eof())
+        {
+            if (!traits_type::eq_int_type(c, traits_type::eof())) {
+                const char_type ch = traits_type::to_char_type(c);
+                push_(&ch, 1);
+            }
+            return traits_type::not_eof(c);
+        }
+
+        virtual std::streamsize xsputn(const char_type* s, std::streamsize n)
+        {
+            if (n > 0)
+                push_(s, n);
+            return n;
+        }
+
+        // The ring is emptied by drain(), not by sync()
+        virtual std::streamsize xsputwaiting()
+        { return 0; }
+
+    private:
+        void push_(const char_type* s, size_t n);
+
+        template <class Sink>
+        size_t drain_(Sink& sink);
+
+        static size_t put_(streambuf_type* sb, const char_type* s, size_t n)
+        { return sb->sputn(s, n); }
+
+        template <class Device>
+        static size_t put_(Device& dev, const char_type* s, size_t n)
+        { return dev.write(reinterpret_cast<const uint8_t*>(s), n * sizeof(char_type)) / sizeof(char_type); }
+
+        // Copy n characters into the ring at position pos
+        void copy_in_(size_t pos, const char_type* s, size_t n)
+        {
+            const size_t i = pos & mask;
+            const size_t k = std::min(n, N - i);
+            traits_type::copy(ring_ + i, s, k);
+            traits_type::copy(ring_, s + k, n - k);
+        }
+    };
+
+    // Output stream writing into a basic_ringbuf
+    template <size_t N, class CharT, class Traits = std::char_traits<CharT>>
+    struct basic_oringstream : basic_ostream<CharT, Traits>
+    {
+        using char_type = CharT;
+        using traits_type = Traits;
+        using ringbuf_type = basic_ringbuf<N, char_type, traits_type>;
+
+        explicit basic_oringstream(ring_overflow policy = ring_overflow::drop_newest)
+        : basic_ostream<char_type, traits_type>(&sb_)
+        , sb_(policy)
+        { }
+
+        virtual ~basic_oringstream()
+        { }
+
+        // Access to the ring, e.g. to drain it
+        ringbuf_type* rdbuf()
+        { return &sb_; }
+
+        template <class Sink>
+        size_t drain(Sink&& sink)
+        { return sb_.drain(sink); }
+
+        size_t dropped() const
+        { return sb_.dropped(); }
+
+    protected:
+        ringbuf_type sb_;
+    };
+
+
+    //
+    // Methods
+    //
+
+    // std::min() takes it by reference
+    template <size_t N, class CharT, class Traits>
+    constexpr size_t basic_ringbuf<N, CharT, Traits>::chunk_size;
+
+    template <size_t N, class CharT, class Traits>
+    inline void basic_ringbuf<N, CharT, Traits>::
+    push_(const char_type* s, size_t n)
+    {
+        const size_t h = head_.load(std::memory_order_relaxed);
+        size_t t = tail_.load(std::memory_order_acquire);
+
+        if (policy_ == ring_overflow::drop_newest) {
+            const size_t room = N - (h - t);
+            if (n > room) {
+                dropped_.fetch_add(n - room, std::memory_order_relaxed);
+                n = room;
+            }
+        }
+        else {
+            // Only the last N characters can be kept
+            if (n > N) {
+                dropped_.fetch_add(n - N, std::memory_order_relaxed);
+                s += n - N;
+                n = N;
+            }
+            // Make room by moving the tail, unless the consumer
+            // already did
+            size_t room = N - (h - t);
+            while (n > room) {
+                if (tail_.compare_exchange_weak(t, t + (n - room),
+                        std::memory_order_acq_rel, std::memory_order_acquire))
+                {
+                    dropped_.fetch_add(n - room, std::memory_order_relaxed);
+                    break;
+                }
+                room = N - (h - t);
+            }
+        }
+
+        copy_in_(h, s, n);
+        head_.store(h + n, std::memory_order_release);
+    }
+
+    template <size_t N, class CharT, class Traits>
+    template <class Sink>
+    inline size_t basic_ringbuf<N, CharT, Traits>::
+    drain_(Sink& sink)
+    {
+        size_t ret = 0;
+        while (true) {
+            size_t t = tail_.load(std::memory_order_acquire);
+            const size_t h = head_.load(std::memory_order_acquire);
+            if (t == h)
+                break;
+
+            // Contiguous readable span
+            const size_t i = t & mask;
+            size_t n = std::min(h - t, N - i);
+            size_t len;
+
+            if (policy_ == ring_overflow::drop_newest) {
+                // The producer never touches the span, write in place
+                len = put_(sink, ring_ + i, n);
+                tail_.store(t + len, std::memory_order_release);
+            }
+            else {
+                // Copy out and commit. If the producer moved the tail
+                // meanwhile, the copy may be overwritten, so retry.
+                char_type chunk[chunk_size];
+                n = std::min(n, chunk_size);
+                traits_type::copy(chunk, ring_ + i, n);
+                if (!tail_.compare_exchange_strong(t, t + n,
+                        std::memory_order_acq_rel, std::memory_order_acquire))
+                    continue;
+                // What the sink does not take is off the ring already
+                len = put_(sink, chunk, n);
+                if (len < n)
+                    dropped_.fetch_add(n - len, std::memory_order_relaxed);
+            }
+
+            ret += len;
+            if (len < n)
+                break;
+        }
+        return ret;
+    }
+
+    //
+    // Alias
+    //
+
+    template <std::size_t N>
+    using ringbuf = basic_ringbuf<N, char>;
+
+    template <std::size_t N>
+    using oringstream = basic_oringstream<N, char>;
+
+} // namespace ard
@@ -0,0 +1,197 @@
+// Copyright (C) 2019 Vladimir Talybin.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+#include <string>
+#include <bits/string_view.hpp>
+#include <istream.hpp>
+
+namespace ard
+{
+    // Splits the input of a stream buffer into tokens, words or lines,
+    // given as views into the get area without copying them. Only a
+    // token that continues past the end of the get area is copied, to
+    // a carry string that is reused. A view is valid until the next
+    // token is read.
+    //
+    // The format flags (e.g. ard::hex) apply to parse().
+    template <class CharT, class Traits = std::char_traits<CharT>,
+              class Alloc = std::allocator<CharT>>
+    struct basic_scanner : ios_base
+    {
+        using char_type = CharT;
+        using traits_type = Traits;
+        using allocator_type = Alloc;
+
+        using int_type = typename traits_type::int_type;
+
+        using streambuf_type = basic_streambuf<char_type, traits_type>;
+        using istream_type = basic_istream<char_type, traits_type>;
+        using string_type = std::basic_string<char_type, traits_type, allocator_type>;
+        using view_type = basic_string_view<char_type, traits_type>;
+
+    protected:
+        streambuf_type* sb_;
+        // Tokens split by a refill of the get area
+        string_type carry_;
+
+    public:
+        explicit basic_scanner(streambuf_type* sb, const allocator_type& a = allocator_type())
+        : sb_(sb)
+        , carry_(a)
+        { }
+
+        // Reads from the buffer of is, with its format flags
+        explicit basic_scanner(istream_type& is, const allocator_type& a = allocator_type())
+        : basic_scanner(is.rdbuf(), a)
+        { this->flags(is.flags()); }
+
+        streambuf_type* rdbuf() const
+        { return sb_; }
+
+        // Next word, skipping whitespace before it. The whitespace
+        // after it is left. Returns false at the end of input.
+        bool next(view_type& tok);
+
+        // Up to the next delim, which is consumed. Returns false at
+        // the end of input.
+        bool next(view_type& tok, char_type delim);
+
+        // Next line, without the '\n'
+        bool line(view_type& tok)
+        { return this->next(tok, ctype<char_type>::widen('\n')); }
+
+        // True when there is no more input
+        bool eof()
+        { return traits_type::eq_int_type(sb_->sgetc(), traits_type::eof()); }
+
+        // Parses all of v into val with num_get, as operator>>
+        // would. Returns false if v is not a value as a whole.
+        template <class ValueT>
+        bool parse(view_type v, ValueT& val)
+        {
+            const num_get<char_type, const char_type*> ng;
+            ios_base::iostate err = ios_base::goodbit;
+            const char_type* p = ng.get(v.begin(), v.end(), *this, err, val);
+            return !(err & ios_base::failbit) && p == v.end();
+        }
+
+        bool parse(view_type v, short& val)
+        { return this->parse_narrow_(v, val); }
+
+        bool parse(view_type v, int& val)
+        { return this->parse_narrow_(v, val); }
+
+    protected:
+        template <class ValueT>
+        bool parse_narrow_(view_type v, ValueT& val)
+        {
+            long l;
+            if (!this->parse(v, l) ||
+                l < std::numeric_limits<ValueT>::min() ||
+                l > std::numeric_limits<ValueT>::max())
+                return false;
+            val = ValueT(l);
+            return true;
+        }
+    };
+
+    //
+    // Methods
+    //
+
+    template <class CharT, class Traits, class Alloc>
+    inline bool basic_scanner<CharT, Traits, Alloc>::
+    next(view_type& tok)
+    {
+        const int_type eof = traits_type::eof();
+        int_type c = skip_wsp(sb_);
+        if (traits_type::eq_int_type(c, eof))
+            return false;
+
+        carry_.clear();
+        do {
+            const char_type* beg = sb_->gptr();
+            const char_type* end = sb_->egptr();
+            if (beg != end) {
+                const char_type* p = find_wsp(beg, end);
+                sb_->sgetconsume(p - beg);
+                if (p != end && carry_.empty()) {
+                    // All in the get area
+                    tok = view_type(beg, p - beg);
+                    return true;
+                }
+                carry_.append(beg, p - beg);
+                c = sb_->sgetc();
+            }
+            else {
+                // Unbuffered
+                carry_ += traits_type::to_char_type(c);
+                c = sb_->snextc();
+            }
+        } while (!traits_type::eq_int_type(c, eof) &&
+                 !is_wsp(traits_type::to_char_type(c)));
+
+        tok = view_type(carry_.data(), carry_.size());
+        return true;
+    }
+
+    template <class CharT, class Traits, class Alloc>
+    inline bool basic_scanner<CharT, Traits, Alloc>::
+    next(view_type& tok, char_type delim)
+    {
+        const int_type eof = traits_type::eof();
+        const int_type idelim = traits_type::to_int_type(delim);
+        int_type c = sb_->sgetc();
+        if (traits_type::eq_int_type(c, eof))
+            return false;
+
+        carry_.clear();
+        while (!traits_type::eq_int_type(c, eof) &&
+               !traits_type::eq_int_type(c, idelim))
+        {
+            const char_type* beg = sb_->gptr();
+            const char_type* end = sb_->egptr();
+            if (beg != end) {
+                const char_type* p = find_char(beg, end, delim);
+                if (p != end && carry_.empty()) {
+                    // All in the get area, delim too
+                    sb_->sgetconsume(p - beg + 1);
+                    tok = view_type(beg, p - beg);
+                    return true;
+                }
+                carry_.append(beg, p - beg);
+                sb_->sgetconsume(p - beg);
+                c = sb_->sgetc();
+            }
+            else {
+                carry_ += traits_type::to_char_type(c);
+                c = sb_->snextc();
+            }
+        }
+        if (!traits_type::eq_int_type(c, eof))
+            sb_->sbumpc();
+
+        tok = view_type(carry_.data(), carry_.size());
+        return true;
+    }
+
+    //
+    // Alias
+    //
+
+    using scanner = basic_scanner<char>;
+
+} // namespace ard
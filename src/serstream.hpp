@@ -18,34 +18,72 @@
 
 namespace ard
 {
-    // Implements an unbuffered basic_streambuf
-    template <class CharT, class Traits = std::char_traits<CharT>>
-    struct basic_serialbuf : basic_streambuf<CharT, Traits>
+    // When a buffered basic_serialbuf writes its put area to the device
+    enum class serial_flush
     {
-        using char_type = CharT;
-        using traits_type = Traits;
+        full,   // When the buffer is full and on sync()/flush()
+        line    // As above and after every '\n' (line buffered)
+    };
+
+    // Device side of the serial stream buffers, shared by
+    // basic_serialbuf and basic_static_serialbuf. Base is the stream
+    // buffer with the get and put areas. Nothing here is virtual, the
+    // buffers call these from their own overflow(), underflow() etc.
+    template <class Base>
+    struct serial_device : Base
+    {
+        using char_type = typename Base::char_type;
+        using traits_type = typename Base::traits_type;
         using serial_type = ::Stream;
 
         using int_type = typename traits_type::int_type;
 
     protected:
-        ios_base::openmode mode_;
         serial_type& serial_;
 
-    public:
-        explicit basic_serialbuf(serial_type& ser,
-            ios_base::openmode mode = ios_base::in | ios_base::out)
-        : mode_(mode)
-        , serial_(ser)
-        { }
+        // Output buffer, nullptr if unbuffered
+        char_type* obuf_ = nullptr;
+        char_type* obuf_end_ = nullptr;
+        serial_flush flush_ = serial_flush::full;
 
-        virtual ~basic_serialbuf()
+        // Input buffer, nullptr if unbuffered
+        char_type* ibuf_ = nullptr;
+        char_type* ibuf_end_ = nullptr;
+
+        // Wait for input up to the stream timeout
+        bool blocking_ = true;
+        // Last input operation ran out of available data
+        bool would_block_ = false;
+
+        explicit serial_device(serial_type& ser)
+        : serial_(ser)
         { }
 
+    public:
         // Get a reference to the wrapped object
         serial_type& serial()
         { return serial_; }
 
+        // Current drain policy of the output buffer
+        serial_flush flush_policy() const
+        { return flush_; }
+
+        // In non-blocking mode input never waits for the device.
+        // Only what available() reports is consumed and running out
+        // of it reports eof with would_block() set.
+        void blocking(bool b)
+        { blocking_ = b; }
+
+        bool blocking() const
+        { return blocking_; }
+
+        // True if the last read from the device ran out of data in
+        // non-blocking mode. Tells "no data yet" apart from a real end
+        // of input or a parse failure. Reads served from the input
+        // buffer do not change it.
+        bool would_block() const
+        { return would_block_; }
+
     protected:
         struct serial_overload : serial_type {
         // Unprotect methods
@@ -53,24 +91,204 @@ namespace ard
             using serial_type::timedPeek;
         };
 
-        // Get how many bytes available
+        serial_overload& ser_()
+        { return static_cast<serial_overload&>(serial_); }
+
+        // Check for input in non-blocking mode. Returns false and
+        // sets would_block() if there is none.
+        bool wait_()
+        {
+            would_block_ = !blocking_ && serial_.available() <= 0;
+            return !would_block_;
+        }
+
+        // Write the pending output to the device in one go.
+        // Returns 0 on success, -1 otherwise.
+        int drain_();
+
+        // Set put area over the output buffer with next write position
+        // at p. In line buffered mode the put area is kept closed, so
+        // every character goes through overflow() where '\n' is detected.
+        void obuf_pptr_(char_type* p)
+        {
+            this->setp(obuf_, flush_ == serial_flush::line ? p : obuf_end_);
+            this->pbump(p - obuf_);
+        }
+
+        // Available bytes, buffered ones included
+        std::streamsize showmanyc_()
+        { return (this->egptr() - this->gptr()) + serial_.available(); }
+
+        // Write a single char, drain on eof
+        int_type overflow_(int_type c);
+
+        // Multiple character insertion
+        std::streamsize xsputn_(const char_type* s, std::streamsize n);
+
+        // Drains the output buffer to make room for n characters.
+        // Not in line buffered mode, where every character must be
+        // seen by overflow().
+        char_type* xsputreserve_(std::streamsize n)
+        {
+            if (!obuf_ || flush_ == serial_flush::line || obuf_end_ - obuf_ < n)
+                return nullptr;
+            return drain_() == 0 ? this->pptr() : nullptr;
+        }
+
+        // Peek a char, refill the input buffer if any
+        int_type underflow_();
+
+        // Read a char
+        int_type uflow_()
+        {
+            if (ibuf_)
+                return Base::uflow();
+            if (!wait_())
+                return traits_type::eof();
+            return blocking_ ? ser_().timedRead() : serial_.read();
+        }
+
+        // Read more into the input buffer until k characters are
+        // available, moving the unread ones to the front first
+        std::streamsize xsgetfill_(std::streamsize k);
+
+        // Multiple character extraction
+        std::streamsize xsgetn_(char_type* s, std::streamsize n);
+
+        // Keep the last character before gptr() for putback and
+        // return where new input goes
+        char_type* keep_putback_()
+        {
+            char_type* beg = ibuf_;
+            if (this->gptr() > this->eback() && ibuf_end_ - ibuf_ > 1)
+                *beg++ = this->gptr()[-1];
+            return beg;
+        }
+
+        // Bytes available, waiting as long as the stream timeout if
+        // there are none. Returns 0 if nothing arrived.
+        std::streamsize available_()
+        {
+            std::streamsize n = serial_.available();
+            if (n <= 0) {
+                if (traits_type::eq_int_type(ser_().timedPeek(), traits_type::eof()))
+                    return 0;
+                n = serial_.available();
+            }
+            return n;
+        }
+    };
+
+    // Implements a basic_streambuf over Arduino Stream. Unbuffered
+    // unless input or output buffers are supplied.
+    template <class CharT, class Traits = std::char_traits<CharT>>
+    struct basic_serialbuf : serial_device<basic_streambuf<CharT, Traits>>
+    {
+        using char_type = CharT;
+        using traits_type = Traits;
+        using serial_type = ::Stream;
+
+        using int_type = typename traits_type::int_type;
+        using streambuf_type = basic_streambuf<char_type, traits_type>;
+        using device_type = serial_device<streambuf_type>;
+
+    protected:
+        ios_base::openmode mode_;
+
+    public:
+        explicit basic_serialbuf(serial_type& ser,
+            ios_base::openmode mode = ios_base::in | ios_base::out)
+        : device_type(ser)
+        , mode_(mode)
+        { }
+
+        // Writes out whatever is left in the output buffer
+        virtual ~basic_serialbuf()
+        { this->drain_(); }
+
+        // Use the array s of n characters as output buffer, drained
+        // to the device as specified by policy. Pending output is
+        // written first. Passing nullptr makes the output unbuffered.
+        void setobuf(char_type* s, std::streamsize n,
+                     serial_flush policy = serial_flush::full);
+
+        // Use the array s of n characters as input buffer, filled with
+        // everything the device has available at once. One character
+        // is kept for putback when n > 1. Buffered input is discarded.
+        // Passing nullptr makes the input unbuffered.
+        void setibuf(char_type* s, std::streamsize n)
+        {
+            if (s && n > 0) {
+                this->ibuf_ = s;
+                this->ibuf_end_ = s + n;
+            }
+            else
+                this->ibuf_ = this->ibuf_end_ = nullptr;
+            this->setg(this->ibuf_, this->ibuf_, this->ibuf_);
+        }
+
+    protected:
+        // Same as setobuf(s, n) for output streams and
+        // setibuf(s, n) for input only streams
+        virtual streambuf_type* setbuf(char_type* s, std::streamsize n)
+        {
+            if (mode_ & ios_base::out)
+                this->setobuf(s, n, this->flush_);
+            else
+                this->setibuf(s, n);
+            return this;
+        }
+
+        // Write out the output buffer
+        virtual int sync()
+        { return this->drain_(); }
+
+        // Get how many bytes available, buffered ones included
         virtual std::streamsize showmanyc()
-        { return serial_.available(); }
+        { return this->showmanyc_(); }
 
         // Write a single char
-        virtual int_type overflow(int_type c = traits_type::eof());
-
-        // Peek a char
+        virtual int_type overflow(int_type c = traits_type::eof())
+        {
+            if (!(mode_ & ios_base::out))
+                return traits_type::eof();
+            return this->overflow_(c);
+        }
+
+        // Peek a char, refill the input buffer if any
         virtual int_type underflow()
-        { return static_cast<serial_overload&>(serial_).timedPeek(); }
+        { return this->underflow_(); }
 
         // Read a char
         virtual int_type uflow()
-        { return static_cast<serial_overload&>(serial_).timedRead(); }
+        { return this->uflow_(); }
+
+        // See serial_device::xsgetfill_()
+        virtual std::streamsize xsgetfill(std::streamsize k)
+        {
+            if (!this->ibuf_)
+                return streambuf_type::xsgetfill(k);
+            return this->xsgetfill_(k);
+        }
+
+        // Put back into the input buffer
+        virtual int_type pbackfail(int_type c = traits_type::eof());
+
+        // Multiple character extraction
+        virtual std::streamsize xsgetn(char_type* s, std::streamsize n)
+        { return this->xsgetn_(s, n); }
 
         // Multiple character insertion
         virtual std::streamsize xsputn(const char_type* s, std::streamsize n)
-        { return serial_.write((const uint8_t*)s, n); }
+        { return this->xsputn_(s, n); }
+
+        // See serial_device::xsputreserve_()
+        virtual char_type* xsputreserve(std::streamsize n)
+        { return this->xsputreserve_(n); }
+
+        // Unbuffered output is on the device already
+        virtual std::streamsize xsputwaiting()
+        { return 0; }
     };
 
     // Input stream
@@ -86,9 +304,23 @@ namespace ard
         , sb_(ser, ios_base::in)
         { }
 
+        // Buffered input into the array ibuf of n characters
+        basic_iserialstream(serial_type& ser, char_type* ibuf, std::streamsize n)
+        : basic_istream<char_type, traits_type>(&sb_)
+        , sb_(ser, ios_base::in)
+        { sb_.setibuf(ibuf, n); }
+
         virtual ~basic_iserialstream()
         { }
 
+        // See basic_serialbuf::blocking()
+        void blocking(bool b)
+        { sb_.blocking(b); }
+
+        // See basic_serialbuf::would_block()
+        bool would_block() const
+        { return sb_.would_block(); }
+
     protected:
         basic_serialbuf<char_type, traits_type> sb_;
     };
@@ -106,6 +338,13 @@ namespace ard
         , sb_(ser, ios_base::out)
         { }
 
+        // Buffered output into the array obuf of n characters
+        basic_oserialstream(serial_type& ser, char_type* obuf, std::streamsize n,
+                            serial_flush policy = serial_flush::full)
+        : basic_ostream<char_type, traits_type>(&sb_)
+        , sb_(ser, ios_base::out)
+        { sb_.setobuf(obuf, n, policy); }
+
         virtual ~basic_oserialstream()
         { }
 
@@ -126,34 +365,271 @@ namespace ard
         , sb_(ser, ios_base::in | ios_base::out)
         { }
 
+        // Buffered output into the array obuf of n characters
+        basic_serialstream(serial_type& ser, char_type* obuf, std::streamsize n,
+                           serial_flush policy = serial_flush::full)
+        : basic_iostream<char_type, traits_type>(&sb_)
+        , sb_(ser, ios_base::in | ios_base::out)
+        { sb_.setobuf(obuf, n, policy); }
+
+        // Buffered input into the array ibuf of in characters and
+        // buffered output into the array obuf of on characters
+        basic_serialstream(serial_type& ser,
+                           char_type* ibuf, std::streamsize in,
+                           char_type* obuf, std::streamsize on,
+                           serial_flush policy = serial_flush::full)
+        : basic_iostream<char_type, traits_type>(&sb_)
+        , sb_(ser, ios_base::in | ios_base::out)
+        {
+            sb_.setibuf(ibuf, in);
+            sb_.setobuf(obuf, on, policy);
+        }
+
         virtual ~basic_serialstream()
         { }
 
+        // See basic_serialbuf::blocking()
+        void blocking(bool b)
+        { sb_.blocking(b); }
+
+        // See basic_serialbuf::would_block()
+        bool would_block() const
+        { return sb_.would_block(); }
+
     protected:
         basic_serialbuf<char_type, traits_type> sb_;
     };
 
+    // Input stream with an internal buffer of N characters
+    template <std::size_t N, class CharT = char,
+              class Traits = std::char_traits<CharT>>
+    struct basic_buffered_iserialstream : basic_iserialstream<CharT, Traits>
+    {
+        using char_type = CharT;
+        using traits_type = Traits;
+        using serial_type = ::Stream;
+
+        explicit basic_buffered_iserialstream(serial_type& ser)
+        : basic_iserialstream<char_type, traits_type>(ser, ibuf_, N)
+        { }
+
+        virtual ~basic_buffered_iserialstream()
+        { }
+
+    protected:
+        char_type ibuf_[N];
+    };
+
+    // Output stream with an internal buffer of N characters
+    template <std::size_t N, class CharT = char,
+              class Traits = std::char_traits<CharT>>
+    struct basic_buffered_oserialstream : basic_oserialstream<CharT, Traits>
+    {
+        using char_type = CharT;
+        using traits_type = Traits;
+        using serial_type = ::Stream;
+
+        explicit basic_buffered_oserialstream(serial_type& ser,
+            serial_flush policy = serial_flush::full)
+        : basic_oserialstream<char_type, traits_type>(ser, obuf_, N, policy)
+        { }
+
+        virtual ~basic_buffered_oserialstream()
+        { this->flush(); }
+
+    protected:
+        char_type obuf_[N];
+    };
+
     //
     // Methods
     //
 
-    template <class CharT, class Traits>
-    inline typename basic_serialbuf<CharT, Traits>::int_type
-    basic_serialbuf<CharT, Traits>::
-    overflow(int_type c)
+    template <class Base>
+    inline int serial_device<Base>::
+    drain_()
     {
-        const bool testout = this->mode_ & ios_base::out;
-        if (!testout)
-            return traits_type::eof();
+        const std::streamsize n = this->pptr() - this->pbase();
+        if (n <= 0)
+            return 0;
+
+        const std::streamsize wrote =
+            serial_.write((const uint8_t*)this->pbase(), n);
+        if (wrote < n) {
+            // Keep what the device did not take
+            const std::streamsize left = n - (wrote > 0 ? wrote : 0);
+            traits_type::move(obuf_, this->pptr() - left, left);
+            obuf_pptr_(obuf_ + left);
+            return -1;
+        }
+        obuf_pptr_(obuf_);
+        return 0;
+    }
 
+    template <class Base>
+    inline typename serial_device<Base>::int_type
+    serial_device<Base>::
+    overflow_(int_type c)
+    {
         const bool testeof = traits_type::eq_int_type(c, traits_type::eof());
         if (testeof)
-            return traits_type::not_eof(c);
+            return drain_() == 0 ? traits_type::not_eof(c) : traits_type::eof();
+
+        if (!obuf_) {
+            serial_.write(c);
+            return c;
+        }
+
+        // Full buffer
+        if (this->pptr() == obuf_end_ && drain_() != 0)
+            return traits_type::eof();
 
-        serial_.write(c);
+        const char_type conv = traits_type::to_char_type(c);
+        *this->pptr() = conv;
+        obuf_pptr_(this->pptr() + 1);
+
+        if (flush_ == serial_flush::line &&
+            traits_type::eq(conv, traits_type::to_char_type('\n')) &&
+            drain_() != 0)
+        {
+            return traits_type::eof();
+        }
         return c;
     }
 
+    template <class Base>
+    inline std::streamsize serial_device<Base>::
+    xsputn_(const char_type* s, std::streamsize n)
+    {
+        if (!obuf_)
+            return serial_.write((const uint8_t*)s, n);
+
+        if (obuf_end_ - this->pptr() < n) {
+            // Does not fit, make room
+            if (drain_() != 0)
+                return 0;
+            // Too large to buffer, write directly
+            if (obuf_end_ - obuf_ <= n)
+                return serial_.write((const uint8_t*)s, n);
+        }
+
+        traits_type::copy(this->pptr(), s, n);
+        obuf_pptr_(this->pptr() + n);
+
+        if (flush_ == serial_flush::line &&
+            traits_type::find(s, n, traits_type::to_char_type('\n')))
+        {
+            drain_();
+        }
+        return n;
+    }
+
+    template <class Base>
+    inline typename serial_device<Base>::int_type
+    serial_device<Base>::
+    underflow_()
+    {
+        if (this->gptr() < this->egptr())
+            return traits_type::to_int_type(*this->gptr());
+
+        if (!wait_())
+            return traits_type::eof();
+        if (!ibuf_)
+            return blocking_ ? ser_().timedPeek() : serial_.peek();
+
+        // Wait for input as long as the stream timeout
+        std::streamsize n = available_();
+        if (n <= 0)
+            return traits_type::eof();
+
+        char_type* beg = keep_putback_();
+        n = serial_.readBytes((char*)beg,
+            std::min(n, std::streamsize(ibuf_end_ - beg)));
+        this->setg(ibuf_, beg, beg + n);
+        return n > 0 ? traits_type::to_int_type(*beg) : traits_type::eof();
+    }
+
+    template <class Base>
+    inline std::streamsize serial_device<Base>::
+    xsgetfill_(std::streamsize k)
+    {
+        std::streamsize n = this->egptr() - this->gptr();
+        char_type* beg = keep_putback_();
+        traits_type::move(beg, this->gptr(), n);
+        this->setg(ibuf_, beg, beg + n);
+
+        while (n < k && this->egptr() < ibuf_end_ && wait_()) {
+            // Wait for input as long as the stream timeout
+            const std::streamsize avail = available_();
+            if (avail <= 0)
+                break;
+
+            const std::streamsize len = serial_.readBytes((char*)this->egptr(),
+                std::min(avail, std::streamsize(ibuf_end_ - this->egptr())));
+            if (len <= 0)
+                break;
+            this->setg(ibuf_, beg, this->egptr() + len);
+            n += len;
+        }
+        return n;
+    }
+
+    template <class Base>
+    inline std::streamsize serial_device<Base>::
+    xsgetn_(char_type* s, std::streamsize n)
+    {
+        std::streamsize ret = std::min(
+            std::streamsize(this->egptr() - this->gptr()), n);
+        if (ret > 0) {
+            traits_type::copy(s, this->gptr(), ret);
+            this->gbump(ret);
+        }
+        // Read the rest at once, waiting as long as the stream timeout
+        if (ret < n && wait_()) {
+            std::streamsize len = n - ret;
+            if (!blocking_) {
+                const std::streamsize avail = serial_.available();
+                would_block_ = avail < len;
+                len = std::min(len, avail);
+            }
+            ret += serial_.readBytes((char*)s + ret, len);
+        }
+        return ret;
+    }
+
+    template <class CharT, class Traits>
+    inline void basic_serialbuf<CharT, Traits>::
+    setobuf(char_type* s, std::streamsize n, serial_flush policy)
+    {
+        this->drain_();
+        this->flush_ = policy;
+        if (s && n > 0) {
+            this->obuf_ = s;
+            this->obuf_end_ = s + n;
+        }
+        else
+            this->obuf_ = this->obuf_end_ = nullptr;
+        this->obuf_pptr_(this->obuf_);
+    }
+
+    template <class CharT, class Traits>
+    inline typename basic_serialbuf<CharT, Traits>::int_type
+    basic_serialbuf<CharT, Traits>::
+    pbackfail(int_type c)
+    {
+        int_type ret = traits_type::eof();
+        if (this->eback() < this->gptr()) {
+            this->gbump(-1);
+            if (traits_type::eq_int_type(c, ret))
+                ret = traits_type::not_eof(c);
+            else {
+                *this->gptr() = traits_type::to_char_type(c);
+                ret = c;
+            }
+        }
+        return ret;
+    }
+
     //
     // Alias
     //
@@ -162,5 +638,10 @@ namespace ard
     using oserialstream = basic_oserialstream<char>;
     using serialstream = basic_serialstream<char>;
 
-} // namespace ard
+    template <std::size_t N>
+    using buffered_iserialstream = basic_buffered_iserialstream<N, char>;
 
+    template <std::size_t N>
+    using buffered_oserialstream = basic_buffered_oserialstream<N, char>;
+
+} // namespace ard
@@ -0,0 +1,418 @@
+// Copyright (C) 2019 Vladimir Talybin.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+#include <iostream.hpp>
+#include <bits/span.hpp>
+
+// Streams over a caller supplied character array (C++23 spanstream).
+// Nothing is allocated, output that does not fit fails and sets
+// badbit, and input is parsed in place.
+namespace ard
+{
+    // Template class basic_spanbuf
+    template <class CharT, class Traits = std::char_traits<CharT>>
+    struct basic_spanbuf : basic_streambuf<CharT, Traits>
+    {
+        using char_type = CharT;
+        using traits_type = Traits;
+
+        using int_type = typename traits_type::int_type;
+        using pos_type = typename traits_type::pos_type;
+        using off_type = typename traits_type::off_type;
+
+        using streambuf_type = basic_streambuf<char_type, traits_type>;
+        using span_type = ard::span<char_type>;
+
+    protected:
+        ios_base::openmode mode_;
+        span_type buf_;
+        // Output did not fit
+        bool overflowed_ = false;
+
+    public:
+        // Starts without a buffer
+        explicit basic_spanbuf(ios_base::openmode mode = ios_base::in | ios_base::out)
+        : streambuf_type()
+        , mode_(mode)
+        { }
+
+        // Starts with the buffer s
+        explicit basic_spanbuf(span_type s,
+            ios_base::openmode mode = ios_base::in | ios_base::out)
+        : streambuf_type()
+        , mode_(mode)
+        { this->span(s); }
+
+        basic_spanbuf(const basic_spanbuf&) = delete;
+
+        basic_spanbuf(basic_spanbuf&& rhs)
+        : streambuf_type(rhs)
+        , mode_(rhs.mode_)
+        , buf_(rhs.buf_)
+        , overflowed_(rhs.overflowed_)
+        { rhs.span(span_type()); }
+
+        // Assign and swap
+
+        basic_spanbuf& operator=(const basic_spanbuf&) = delete;
+
+        basic_spanbuf& operator=(basic_spanbuf&& rhs)
+        {
+            const streambuf_type& base = rhs;
+            streambuf_type::operator=(base);
+            mode_ = rhs.mode_;
+            buf_ = rhs.buf_;
+            overflowed_ = rhs.overflowed_;
+            rhs.span(span_type());
+            return *this;
+        }
+
+        void swap(basic_spanbuf& rhs)
+        {
+            streambuf_type& base = rhs;
+            streambuf_type::swap(base);
+            std::swap(mode_, rhs.mode_);
+            std::swap(buf_, rhs.buf_);
+            std::swap(overflowed_, rhs.overflowed_);
+        }
+
+        //
+        // Get and set
+        //
+
+        // What was written in output mode, the whole buffer otherwise
+        span_type span() const
+        {
+            if (mode_ & ios_base::out)
+                return span_type(this->pbase(), this->pptr());
+            return buf_;
+        }
+
+        // Use the buffer s. Output starts at the end of it with
+        // ios_base::ate, at the beginning otherwise.
+        void span(span_type s)
+        {
+            buf_ = s;
+            overflowed_ = false;
+            if (mode_ & ios_base::out) {
+                this->setp(s.data(), s.data() + s.size());
+                if (mode_ & ios_base::ate)
+                    this->pbump(s.size());
+            }
+            if (mode_ & ios_base::in)
+                this->setg(s.data(), s.data(), s.data() + s.size());
+        }
+
+        // True if output was dropped since the buffer was set
+        bool overflowed() const
+        { return overflowed_; }
+
+    protected:
+        // Same as span(span_type(s, n))
+        virtual streambuf_type* setbuf(char_type* s, std::streamsize n)
+        {
+            this->span(span_type(s, n));
+            return this;
+        }
+
+        // The buffer is full
+        virtual int_type overflow(int_type c = traits_type::eof())
+        {
+            if (traits_type::eq_int_type(c, traits_type::eof()))
+                return traits_type::not_eof(c);
+            overflowed_ = true;
+            return traits_type::eof();
+        }
+
+        virtual pos_type seekoff(off_type off, ios_base::seekdir way,
+            ios_base::openmode mode = ios_base::in | ios_base::out);
+
+        virtual pos_type seekpos(pos_type sp,
+            ios_base::openmode mode = ios_base::in | ios_base::out)
+        { return this->seekoff(off_type(sp), ios_base::beg, mode); }
+    };
+
+
+    // Template class basic_ispanstream
+    template <class CharT, class Traits = std::char_traits<CharT>>
+    struct basic_ispanstream : basic_istream<CharT, Traits>
+    {
+        using char_type = CharT;
+        using traits_type = Traits;
+
+        using int_type = typename traits_type::int_type;
+        using pos_type = typename traits_type::pos_type;
+        using off_type = typename traits_type::off_type;
+
+        using spanbuf_type = basic_spanbuf<char_type, traits_type>;
+        using span_type = ard::span<char_type>;
+        using istream_type = basic_istream<char_type, traits_type>;
+
+    private:
+        spanbuf_type span_buf_;
+
+    public:
+        // Parses s in place, it is never written to
+        explicit basic_ispanstream(ard::span<const char_type> s,
+            ios_base::openmode mode = ios_base::in)
+        : istream_type()
+        , span_buf_(span_(s), mode | ios_base::in)
+        { this->init(&span_buf_); }
+
+        // A string literal, without its terminating null character
+        template <size_t N>
+        explicit basic_ispanstream(const char_type (&s)[N],
+            ios_base::openmode mode = ios_base::in)
+        : basic_ispanstream(literal_(s), mode)
+        { }
+
+        // All of a writable array
+        template <size_t N>
+        explicit basic_ispanstream(char_type (&s)[N],
+            ios_base::openmode mode = ios_base::in)
+        : basic_ispanstream(ard::span<const char_type>(s, N), mode)
+        { }
+
+        basic_ispanstream(const basic_ispanstream&) = delete;
+
+        basic_ispanstream(basic_ispanstream&& rhs)
+        : istream_type(std::move(rhs))
+        , span_buf_(std::move(rhs.span_buf_))
+        { istream_type::set_rdbuf(&span_buf_); }
+
+        // Assign and swap
+
+        basic_ispanstream& operator=(const basic_ispanstream&) = delete;
+
+        basic_ispanstream& operator=(basic_ispanstream&& rhs)
+        {
+            istream_type::operator=(std::move(rhs));
+            span_buf_ = std::move(rhs.span_buf_);
+            return *this;
+        }
+
+        void swap(basic_ispanstream& rhs)
+        {
+            istream_type::swap(rhs);
+            span_buf_.swap(rhs.span_buf_);
+        }
+
+        // Accessing the underlying buffer
+        spanbuf_type* rdbuf() const
+        { return const_cast<spanbuf_type*>(&span_buf_); }
+
+        ard::span<const char_type> span() const
+        { return span_buf_.span(); }
+
+        void span(ard::span<const char_type> s)
+        { span_buf_.span(span_(s)); }
+
+        template <size_t N>
+        void span(const char_type (&s)[N])
+        { span_buf_.span(span_(literal_(s))); }
+
+        template <size_t N>
+        void span(char_type (&s)[N])
+        { span_buf_.span(span_type(s, N)); }
+
+    private:
+        // The get area is never written through
+        static span_type span_(ard::span<const char_type> s)
+        { return span_type(const_cast<char_type*>(s.data()), s.size()); }
+
+        template <size_t N>
+        static ard::span<const char_type> literal_(const char_type (&s)[N])
+        {
+            const bool nul = traits_type::eq(s[N - 1], char_type());
+            return ard::span<const char_type>(s, nul ? N - 1 : N);
+        }
+    };
+
+
+    // Template class basic_ospanstream
+    template <class CharT, class Traits = std::char_traits<CharT>>
+    struct basic_ospanstream : basic_ostream<CharT, Traits>
+    {
+        using char_type = CharT;
+        using traits_type = Traits;
+
+        using int_type = typename traits_type::int_type;
+        using pos_type = typename traits_type::pos_type;
+        using off_type = typename traits_type::off_type;
+
+        using spanbuf_type = basic_spanbuf<char_type, traits_type>;
+        using span_type = ard::span<char_type>;
+        using ostream_type = basic_ostream<char_type, traits_type>;
+
+    private:
+        spanbuf_type span_buf_;
+
+    public:
+        explicit basic_ospanstream(span_type s,
+            ios_base::openmode mode = ios_base::out)
+        : ostream_type()
+        , span_buf_(s, mode | ios_base::out)
+        { this->init(&span_buf_); }
+
+        basic_ospanstream(const basic_ospanstream&) = delete;
+
+        basic_ospanstream(basic_ospanstream&& rhs)
+        : ostream_type(std::move(rhs))
+        , span_buf_(std::move(rhs.span_buf_))
+        { ostream_type::set_rdbuf(&span_buf_); }
+
+        // Assign and swap
+
+        basic_ospanstream& operator=(const basic_ospanstream&) = delete;
+
+        basic_ospanstream& operator=(basic_ospanstream&& rhs)
+        {
+            ostream_type::operator=(std::move(rhs));
+            span_buf_ = std::move(rhs.span_buf_);
+            return *this;
+        }
+
+        void swap(basic_ospanstream& rhs)
+        {
+            ostream_type::swap(rhs);
+            span_buf_.swap(rhs.span_buf_);
+        }
+
+        // Accessing the underlying buffer
+        spanbuf_type* rdbuf() const
+        { return const_cast<spanbuf_type*>(&span_buf_); }
+
+        // What was written
+        span_type span() const
+        { return span_buf_.span(); }
+
+        void span(span_type s)
+        { span_buf_.span(s); }
+    };
+
+
+    // Template class basic_spanstream
+    template <class CharT, class Traits = std::char_traits<CharT>>
+    struct basic_spanstream : basic_iostream<CharT, Traits>
+    {
+        using char_type = CharT;
+        using traits_type = Traits;
+
+        using int_type = typename traits_type::int_type;
+        using pos_type = typename traits_type::pos_type;
+        using off_type = typename traits_type::off_type;
+
+        using spanbuf_type = basic_spanbuf<char_type, traits_type>;
+        using span_type = ard::span<char_type>;
+        using iostream_type = basic_iostream<char_type, traits_type>;
+
+    private:
+        spanbuf_type span_buf_;
+
+    public:
+        explicit basic_spanstream(span_type s,
+            ios_base::openmode mode = ios_base::in | ios_base::out)
+        : iostream_type()
+        , span_buf_(s, mode)
+        { this->init(&span_buf_); }
+
+        basic_spanstream(const basic_spanstream&) = delete;
+
+        basic_spanstream(basic_spanstream&& rhs)
+        : iostream_type(std::move(rhs))
+        , span_buf_(std::move(rhs.span_buf_))
+        { iostream_type::set_rdbuf(&span_buf_); }
+
+        // Assign and swap
+
+        basic_spanstream& operator=(const basic_spanstream&) = delete;
+
+        basic_spanstream& operator=(basic_spanstream&& rhs)
+        {
+            iostream_type::operator=(std::move(rhs));
+            span_buf_ = std::move(rhs.span_buf_);
+            return *this;
+        }
+
+        void swap(basic_spanstream& rhs)
+        {
+            iostream_type::swap(rhs);
+            span_buf_.swap(rhs.span_buf_);
+        }
+
+        // Accessing the underlying buffer
+        spanbuf_type* rdbuf() const
+        { return const_cast<spanbuf_type*>(&span_buf_); }
+
+        // What was written
+        span_type span() const
+        { return span_buf_.span(); }
+
+        void span(span_type s)
+        { span_buf_.span(s); }
+    };
+
+
+    //
+    // Methods
+    //
+
+    template <class CharT, class Traits>
+    inline typename basic_spanbuf<CharT, Traits>::pos_type
+    basic_spanbuf<CharT, Traits>::
+    seekoff(off_type off, ios_base::seekdir way, ios_base::openmode mode)
+    {
+        const pos_type fail = pos_type(off_type(-1));
+        const bool testin = ios_base::in & this->mode_ & mode;
+        const bool testout = ios_base::out & this->mode_ & mode;
+        if (!testin && !testout)
+            return fail;
+        // Both positions may not move relative to different places
+        if (testin && testout && way == ios_base::cur)
+            return fail;
+
+        off_type base = 0;
+        if (way == ios_base::cur)
+            base = testin ? this->gptr() - this->eback() : this->pptr() - this->pbase();
+        else if (way == ios_base::end) {
+            // Output only streams end at what was written
+            base = (this->mode_ & ios_base::out) && !(this->mode_ & ios_base::in) ?
+                this->pptr() - this->pbase() : off_type(buf_.size());
+        }
+
+        const off_type pos = base + off;
+        if (pos < 0 || pos > off_type(buf_.size()))
+            return fail;
+
+        if (testin)
+            this->setg(this->eback(), this->eback() + pos, this->egptr());
+        if (testout) {
+            this->setp(this->pbase(), this->epptr());
+            this->pbump(pos);
+        }
+        return pos_type(pos);
+    }
+
+    //
+    // Alias
+    //
+
+    using spanbuf = basic_spanbuf<char>;
+    using ispanstream = basic_ispanstream<char>;
+    using ospanstream = basic_ospanstream<char>;
+    using spanstream = basic_spanstream<char>;
+
+} // namespace ard
@@ -22,11 +22,20 @@
 
 #pragma once
 #include <string>
+#include <bits/string_view.hpp>
 #include <istream.hpp>
 #include <ostream.hpp>
 
 namespace ard
 {
+    // How basic_stringbuf grows its string when output does not fit
+    struct stringbuf_growth
+    {
+        std::size_t initial = 512;  // Least capacity of the first allocation
+        unsigned factor = 2;        // Capacity is multiplied by this
+        std::size_t limit = 0;      // Most capacity, output fails beyond it (0 if none)
+    };
+
     // Template class basic_stringbuf
     template <class CharT, class Traits, class Alloc>
     struct basic_stringbuf : basic_streambuf<CharT, Traits>
@@ -43,6 +52,7 @@ namespace ard
         using string_type =
             std::basic_string<char_type, traits_type, allocator_type>;
         using size_type = typename string_type::size_type;
+        using view_type = basic_string_view<char_type, traits_type>;
 
     private:
         struct xfer_bufptrs;
@@ -51,6 +61,7 @@ namespace ard
         // Place to stash in || out || in | out settings for current stringbuf
         ios_base::openmode mode_;
         string_type string_;
+        stringbuf_growth growth_;
 
     public:
         // Starts with an empty string buffer
@@ -60,12 +71,31 @@ namespace ard
         , string_()
         { }
 
+        // Starts with an empty string buffer using the allocator a
+        explicit basic_stringbuf(const allocator_type& a)
+        : basic_stringbuf(ios_base::in | ios_base::out, a)
+        { }
+
+        basic_stringbuf(ios_base::openmode mode, const allocator_type& a)
+        : streambuf_type()
+        , mode_(mode)
+        , string_(a)
+        { }
+
         //Starts with an existing string buffer
         explicit basic_stringbuf(const string_type& str,
 		    ios_base::openmode mode = ios_base::in | ios_base::out)
         : streambuf_type()
         , mode_()
-        , string_(str.data(), str.size())
+        , string_(str.data(), str.size(), str.get_allocator())
+        { string_buf_init(mode); }
+
+        // Starts with the string buffer str, moved in
+        explicit basic_stringbuf(string_type&& str,
+		    ios_base::openmode mode = ios_base::in | ios_base::out)
+        : streambuf_type()
+        , mode_()
+        , string_(std::move(str))
         { string_buf_init(mode); }
 
         basic_stringbuf(const basic_stringbuf&) = delete;
@@ -85,6 +115,7 @@ namespace ard
 	        streambuf_type::operator=(base);
 	        mode_ = rhs.mode_;
 	        string_ = std::move(rhs.string_);
+	        growth_ = rhs.growth_;
 	        rhs.sync_(const_cast<char_type*>(rhs.string_.data()), 0, 0);
 	        return *this;
         }
@@ -97,6 +128,7 @@ namespace ard
 	        streambuf_type::swap(base);
 	        std::swap(mode_, rhs.mode_);
 	        std::swap(string_, rhs.string_);
+	        std::swap(growth_, rhs.growth_);
         }
 
         //
@@ -104,19 +136,41 @@ namespace ard
         //
 
         // Copying out the string buffer
-        string_type str() const
+        string_type str() const &
+        {
+	        const view_type v = this->view();
+	        return string_type(v.data(), v.size(), string_.get_allocator());
+        }
+
+        // Moving out the string buffer, which is left empty
+        string_type str() &&
+        {
+	        string_type ret(string_.get_allocator());
+	        if (this->pptr() && this->pbase() == string_.data()) {
+	            // The string is kept at its capacity, cut it at the end
+	            string_.resize(this->view().size());
+	            ret = std::move(string_);
+	        }
+	        else if (this->pptr())
+	            ret = this->str();
+	        else
+	            ret = std::move(string_);
+	        string_.clear();
+	        sync_(const_cast<char_type*>(string_.data()), 0, 0);
+	        return ret;
+        }
+
+        // View of the string buffer, valid until the next output or
+        // change of the buffer
+        view_type view() const
         {
-	        string_type ret;
 	        if (this->pptr()) {
 	            // The current egptr() may not be the actual string end
 	            if (this->pptr() > this->egptr())
-	                ret = string_type(this->pbase(), this->pptr());
-	            else
- 	                ret = string_type(this->pbase(), this->egptr());
+	                return view_type(this->pbase(), this->pptr() - this->pbase());
+	            return view_type(this->pbase(), this->egptr() - this->pbase());
 	        }
-	        else
-	            ret = string_;
-	        return ret;
+	        return view_type(string_.data(), string_.size());
         }
 
         // Setting a new buffer
@@ -128,6 +182,28 @@ namespace ard
 	        string_buf_init(mode_);
         }
 
+        // Adopting s as the new buffer
+        void str(string_type&& s)
+        {
+	        string_ = std::move(s);
+	        string_buf_init(mode_);
+        }
+
+        // Growth of the string on output, see stringbuf_growth
+        void growth(const stringbuf_growth& g)
+        { growth_ = g; }
+
+        const stringbuf_growth& growth() const
+        { return growth_; }
+
+        // Room for n characters of output in all, up to the growth
+        // limit, so that no reallocation is needed until then
+        void reserve(size_type n)
+        {
+	        if ((mode_ & ios_base::out) && n > size_type(this->epptr() - this->pbase()))
+	            realloc_(std::min(n, limit_()));
+        }
+
     protected:
         // Common initialization code goes here
         void string_buf_init(ios_base::openmode mode)
@@ -151,10 +227,21 @@ namespace ard
 
         virtual int_type underflow();
 
+        // All of the string is in the get area, up to what was written
+        virtual std::streamsize xsgetfill(std::streamsize)
+        {
+	        if (mode_ & ios_base::in)
+	            update_egptr_();
+	        return this->egptr() - this->gptr();
+        }
+
         virtual int_type pbackfail(int_type c = traits_type::eof());
 
         virtual int_type overflow(int_type c = traits_type::eof());
 
+        // Grows the string to make room for n characters
+        virtual char_type* xsputreserve(std::streamsize n);
+
         // Manipulates the buffer
         virtual streambuf_type* setbuf(char_type* s, std::streamsize n)
         {
@@ -184,6 +271,20 @@ namespace ard
         // of an existing string_.
         void sync_(char_type* base, size_type i, size_type o);
 
+        // Room for need characters from pbase(), growing string_ as
+        // growth_ allows. Returns false if it may not be that large.
+        bool grow_(size_type need);
+
+        // Moves the content to string_ with a capacity of len
+        // characters, keeping the get and put positions
+        void realloc_(size_type len);
+
+        size_type limit_() const
+        {
+	        const size_type max_size = string_.max_size();
+	        return growth_.limit ? std::min(size_type(growth_.limit), max_size) : max_size;
+        }
+
         // Internal function for correctly updating egptr() to the actual
         // string end.
         void update_egptr_()
@@ -209,28 +310,17 @@ namespace ard
 	        xfer_bufptrs(const basic_stringbuf& from, basic_stringbuf* to)
 	        : to_{to}, goff_{-1, -1, -1}, poff_{-1, -1, -1}
 	        {
+	            // NB: string_ already covers both areas, see sync_()
 	            const char_type* const str = from.string_.data();
-	            const char_type* end = nullptr;
 	            if (from.eback()) {
 	                goff_[0] = from.eback() - str;
 	                goff_[1] = from.gptr() - str;
 	                goff_[2] = from.egptr() - str;
-	                end = from.egptr();
 	            }
 	            if (from.pbase()) {
 	                poff_[0] = from.pbase() - str;
 	                poff_[1] = from.pptr() - from.pbase();
 	                poff_[2] = from.epptr() - str;
-	                if (from.pptr() > end)
-		                end = from.pptr();
-	            }
-
-	            // Set string_ length to the greater of the get and put areas
-	            if (end) {
-	                // The const_cast avoids changing this constructor's signature,
-	                // because it is exported from the dynamic library.
-	                auto& mut_from = const_cast<basic_stringbuf&>(from);
-	                mut_from.string_.length_(end - str);
 	            }
 	        }
 
@@ -254,6 +344,7 @@ namespace ard
         : streambuf_type(static_cast<const streambuf_type&>(rhs))
         , mode_(rhs.mode_)
         , string_(std::move(rhs.string_))
+        , growth_(rhs.growth_)
         { }
     };
 
@@ -275,6 +366,7 @@ namespace ard
             std::basic_string<char_type, traits_type, allocator_type>;
         using stringbuf_type =
             basic_stringbuf<char_type, traits_type, allocator_type>;
+        using view_type = basic_string_view<char_type, traits_type>;
         using istream_type = basic_istream<char_type, traits_type>;
 
     private:
@@ -294,6 +386,19 @@ namespace ard
         , string_buf_(str, mode | ios_base::in)
         { this->init(&string_buf_); }
 
+        // Starts with an empty string buffer using the allocator a
+        basic_istringstream(ios_base::openmode mode, const allocator_type& a)
+        : istream_type()
+        , string_buf_(mode | ios_base::in, a)
+        { this->init(&string_buf_); }
+
+        // Starts with the string buffer str, moved in
+        explicit basic_istringstream(string_type&& str,
+            ios_base::openmode mode = ios_base::in)
+        : istream_type()
+        , string_buf_(std::move(str), mode | ios_base::in)
+        { this->init(&string_buf_); }
+
         // The destructor does nothing.
         ~basic_istringstream()
         { }
@@ -327,12 +432,23 @@ namespace ard
         { return const_cast<stringbuf_type*>(&string_buf_); }
 
         // Copying out the string buffer
-        string_type str() const
+        string_type str() const &
         { return string_buf_.str(); }
 
+        // Moving out the string buffer
+        string_type str() &&
+        { return std::move(string_buf_).str(); }
+
+        // View of the string buffer
+        view_type view() const
+        { return string_buf_.view(); }
+
         // Setting a new buffer
         void str(const string_type& s)
         { string_buf_.str(s); }
+
+        void str(string_type&& s)
+        { string_buf_.str(std::move(s)); }
     };
 
 
@@ -353,6 +469,7 @@ namespace ard
             std::basic_string<char_type, traits_type, allocator_type>;
         using stringbuf_type =
             basic_stringbuf<char_type, traits_type, allocator_type>;
+        using view_type = basic_string_view<char_type, traits_type>;
         using ostream_type = basic_ostream<char_type, traits_type>;
 
     private:
@@ -372,6 +489,23 @@ namespace ard
         , string_buf_(str, mode | ios_base::out)
         { this->init(&string_buf_); }
 
+        // Starts with an empty string buffer using the allocator a
+        explicit basic_ostringstream(const allocator_type& a)
+        : basic_ostringstream(ios_base::out, a)
+        { }
+
+        basic_ostringstream(ios_base::openmode mode, const allocator_type& a)
+        : ostream_type()
+        , string_buf_(mode | ios_base::out, a)
+        { this->init(&string_buf_); }
+
+        // Starts with the string buffer str, moved in
+        explicit basic_ostringstream(string_type&& str,
+            ios_base::openmode mode = ios_base::out)
+        : ostream_type()
+        , string_buf_(std::move(str), mode | ios_base::out)
+        { this->init(&string_buf_); }
+
         // The destructor does nothing
         ~basic_ostringstream()
         { }
@@ -405,12 +539,27 @@ namespace ard
         { return const_cast<stringbuf_type*>(&string_buf_); }
 
         // Copying out the string buffer
-        string_type str() const
+        string_type str() const &
         { return string_buf_.str(); }
 
+        // Moving out the string buffer
+        string_type str() &&
+        { return std::move(string_buf_).str(); }
+
+        // View of the string buffer
+        view_type view() const
+        { return string_buf_.view(); }
+
         // Setting a new buffer
         void str(const string_type& s)
         { string_buf_.str(s); }
+
+        void str(string_type&& s)
+        { string_buf_.str(std::move(s)); }
+
+        // See basic_stringbuf::reserve()
+        void reserve(typename string_type::size_type n)
+        { string_buf_.reserve(n); }
     };
 
 
@@ -431,6 +580,7 @@ namespace ard
             std::basic_string<char_type, traits_type, allocator_type>;
         using stringbuf_type =
             basic_stringbuf<char_type, traits_type, allocator_type>;
+        using view_type = basic_string_view<char_type, traits_type>;
         using iostream_type = basic_iostream<char_type, traits_type>;
 
     private:
@@ -451,6 +601,23 @@ namespace ard
         , string_buf_(str, m)
         { this->init(&string_buf_); }
 
+        // Starts with an empty string buffer using the allocator a
+        explicit basic_stringstream(const allocator_type& a)
+        : basic_stringstream(ios_base::out | ios_base::in, a)
+        { }
+
+        basic_stringstream(ios_base::openmode m, const allocator_type& a)
+        : iostream_type()
+        , string_buf_(m, a)
+        { this->init(&string_buf_); }
+
+        // Starts with the string buffer str, moved in
+        explicit basic_stringstream(string_type&& str,
+	        ios_base::openmode m = ios_base::out | ios_base::in)
+        : iostream_type()
+        , string_buf_(std::move(str), m)
+        { this->init(&string_buf_); }
+
         // The destructor does nothing
         ~basic_stringstream()
         { }
@@ -484,12 +651,180 @@ namespace ard
         { return const_cast<stringbuf_type*>(&string_buf_); }
 
         // Copying out the string buffer
-        string_type str() const
+        string_type str() const &
+        { return string_buf_.str(); }
+
+        // Moving out the string buffer
+        string_type str() &&
+        { return std::move(string_buf_).str(); }
+
+        // View of the string buffer
+        view_type view() const
+        { return string_buf_.view(); }
+
+        // Setting a new buffer
+        void str(const string_type& s)
+        { string_buf_.str(s); }
+
+        void str(string_type&& s)
+        { string_buf_.str(std::move(s)); }
+
+        // See basic_stringbuf::reserve()
+        void reserve(typename string_type::size_type n)
+        { string_buf_.reserve(n); }
+    };
+
+    // String buffer that formats into N characters of inline storage
+    // and moves to the heap only when the content grows beyond that
+    template <std::size_t N, class CharT = char, class Traits = std::char_traits<CharT>,
+              class Alloc = std::allocator<CharT>>
+    struct basic_small_stringbuf : basic_stringbuf<CharT, Traits, Alloc>
+    {
+        using char_type = CharT;
+        using traits_type = Traits;
+        using allocator_type = Alloc;
+
+        using stringbuf_type = basic_stringbuf<char_type, traits_type, allocator_type>;
+        using string_type = typename stringbuf_type::string_type;
+
+    protected:
+        char_type buf_[N];
+
+    public:
+        // Starts empty in the inline storage. The first heap
+        // allocation is at least 2 * N characters.
+        explicit basic_small_stringbuf(ios_base::openmode mode = ios_base::in | ios_base::out)
+        : stringbuf_type(mode)
+        {
+            this->growth_.initial = 2 * N;
+            if (mode & ios_base::out)
+                inline_(0, 0);
+        }
+
+        // Inline storage cannot be moved
+        basic_small_stringbuf(basic_small_stringbuf&&) = delete;
+        basic_small_stringbuf& operator=(basic_small_stringbuf&&) = delete;
+        void swap(basic_small_stringbuf&) = delete;
+
+        // True while the content is in the inline storage
+        bool is_inline() const
+        { return this->pbase() == buf_; }
+
+        string_type str() const &
+        { return stringbuf_type::str(); }
+
+        // Moving out the string buffer, which returns to inline storage
+        string_type str() &&
+        {
+            string_type ret = static_cast<stringbuf_type&&>(*this).str();
+            if (this->mode_ & ios_base::out)
+                inline_(0, 0);
+            return ret;
+        }
+
+        // Setting a new buffer, inline if it fits. Input only buffers
+        // read from the string as basic_stringbuf does.
+        void str(const string_type& s)
+        {
+            if (s.size() > N || !(this->mode_ & ios_base::out))
+                stringbuf_type::str(s);
+            else {
+                traits_type::copy(buf_, s.data(), s.size());
+                this->string_.clear();
+                inline_(s.size(), (this->mode_ & (ios_base::ate | ios_base::app)) ? s.size() : 0);
+            }
+        }
+
+        void str(string_type&& s)
+        {
+            if (s.size() > N || !(this->mode_ & ios_base::out))
+                stringbuf_type::str(std::move(s));
+            else
+                this->str(s);
+        }
+
+    protected:
+        // Spills to the heap, as overflow() does
+        virtual char_type* xsputreserve(std::streamsize n)
+        {
+            if ((this->mode_ & ios_base::out) && is_inline())
+                return this->grow_(this->pptr() - this->pbase() + n) ? this->pptr() : nullptr;
+            return stringbuf_type::xsputreserve(n);
+        }
+
+        // Get and put areas over the inline storage with len
+        // characters of content, output at off. The content ends at
+        // pptr() or egptr(), so it is only used with output.
+        void inline_(std::size_t len, std::size_t off)
+        {
+            if (this->mode_ & ios_base::in)
+                this->setg(buf_, buf_, buf_ + len);
+            else
+                this->setg(buf_ + len, buf_ + len, buf_ + len);
+            if (this->mode_ & ios_base::out) {
+                this->setp(buf_, buf_ + N);
+                this->pbump(off);
+            }
+        }
+    };
+
+    // Output string stream with N characters of inline storage, see
+    // basic_small_stringbuf
+    template <std::size_t N, class CharT = char, class Traits = std::char_traits<CharT>,
+              class Alloc = std::allocator<CharT>>
+    struct basic_small_ostringstream : basic_ostream<CharT, Traits>
+    {
+        using char_type = CharT;
+        using traits_type = Traits;
+        using allocator_type = Alloc;
+
+        using stringbuf_type =
+            basic_small_stringbuf<N, char_type, traits_type, allocator_type>;
+        using string_type = typename stringbuf_type::string_type;
+        using view_type = typename stringbuf_type::view_type;
+        using ostream_type = basic_ostream<char_type, traits_type>;
+
+    private:
+        stringbuf_type string_buf_;
+
+    public:
+        explicit basic_small_ostringstream(ios_base::openmode mode = ios_base::out)
+        : ostream_type()
+        , string_buf_(mode | ios_base::out)
+        { this->init(&string_buf_); }
+
+        // Starts with a copy of str
+        explicit basic_small_ostringstream(const string_type& str,
+            ios_base::openmode mode = ios_base::out)
+        : basic_small_ostringstream(mode)
+        { string_buf_.str(str); }
+
+        // Accessing the underlying buffer
+        stringbuf_type* rdbuf() const
+        { return const_cast<stringbuf_type*>(&string_buf_); }
+
+        // Copying out the string buffer
+        string_type str() const &
         { return string_buf_.str(); }
 
+        // Moving out the string buffer
+        string_type str() &&
+        { return std::move(string_buf_).str(); }
+
+        // View of the string buffer
+        view_type view() const
+        { return string_buf_.view(); }
+
         // Setting a new buffer
         void str(const string_type& s)
         { string_buf_.str(s); }
+
+        void str(string_type&& s)
+        { string_buf_.str(std::move(s)); }
+
+        // See basic_stringbuf::reserve()
+        void reserve(typename string_type::size_type n)
+        { string_buf_.reserve(n); }
     };
 
     // Swap specialization for stringbufs
@@ -562,53 +897,72 @@ namespace ard
         if (testeof)
             return traits_type::not_eof(c);
 
-        const size_type capacity = string_.capacity();
-
-        if (size_type(this->epptr() - this->pbase()) < capacity) {
-            // There is additional capacity in string_ that can be used
-            char_type* base = const_cast<char_type*>(string_.data());
-            pbump_(base, base + capacity, this->pptr() - this->pbase());
-            if (mode_ & ios_base::in) {
-                const size_type nget = this->gptr() - this->eback();
-                const size_type eget = this->egptr() - this->eback();
-                this->setg(base, base + nget, base + eget + 1);
-            }
-            *this->pptr() = traits_type::to_char_type(c);
-            this->pbump(1);
-            return c;
-        }
-
-        const size_type max_size = string_.max_size();
-        const bool testput = this->pptr() < this->epptr();
-        if (!testput && capacity == max_size)
+        if (this->pptr() == this->epptr()
+            && !grow_(this->pptr() - this->pbase() + 1))
+        {
             return traits_type::eof();
-
-        // Try to append c into output sequence in one of two ways.
-        // Order these tests done in is unspecified by the standard.
-        const char_type conv = traits_type::to_char_type(c);
-        if (!testput) {
-            // NB: Start ostringstream buffers at 512 chars. This is an
-            // experimental value (pronounced "arbitrary" in some of the
-            // hipper English-speaking countries), and can be changed to
-            // suit particular needs.
-            const size_type opt_len =
-                std::max(size_type(2 * capacity), size_type(512));
-            const size_type len = std::min(opt_len, max_size);
-            string_type tmp;
-            tmp.reserve(len);
-            if (this->pbase())
-                tmp.assign(this->pbase(), this->epptr() - this->pbase());
-            tmp.push_back(conv);
-            string_.swap(tmp);
-            sync_(const_cast<char_type*>(string_.data()),
-                this->gptr() - this->eback(), this->pptr() - this->pbase());
         }
-        else
-            *this->pptr() = conv;
+        *this->pptr() = traits_type::to_char_type(c);
         this->pbump(1);
         return c;
     }
 
+    template <class CharT, class Traits, class Alloc>
+    inline CharT* basic_stringbuf<CharT, Traits, Alloc>::
+    xsputreserve(std::streamsize n)
+    {
+        const bool testout = this->mode_ & ios_base::out;
+        // Not for an external buffer given to setbuf()
+        if (!testout || (this->pbase() && this->pbase() != string_.data()))
+            return nullptr;
+        return grow_(this->pptr() - this->pbase() + n) ? this->pptr() : nullptr;
+    }
+
+    template <class CharT, class Traits, class Alloc>
+    inline bool basic_stringbuf<CharT, Traits, Alloc>::
+    grow_(size_type need)
+    {
+        const size_type limit = limit_();
+        if (need > limit)
+            return false;
+
+        // By the factor, at least to the initial size and what is needed
+        const size_type capacity = string_.capacity();
+        const size_type factor = std::max(growth_.factor, 1u);
+        size_type len = capacity > limit / factor ? limit : capacity * factor;
+        len = std::max(len, std::max(size_type(growth_.initial), need));
+        realloc_(std::min(len, limit));
+        return true;
+    }
+
+    template <class CharT, class Traits, class Alloc>
+    inline void basic_stringbuf<CharT, Traits, Alloc>::
+    realloc_(size_type len)
+    {
+        char_type* const beg = this->pbase();
+        const size_type goff = this->gptr() - this->eback();
+        const size_type gend = this->egptr() - this->eback();
+        const size_type poff = this->pptr() - beg;
+        const size_type hi = std::max(this->pptr(), this->egptr()) - beg;
+
+        // Only the content is copied on reallocation
+        if (beg == string_.data())
+            string_.resize(hi);
+        else if (beg)
+            string_.assign(beg, hi);    // From an external buffer
+        else
+            string_.clear();
+        string_.reserve(len);
+        string_.resize(std::min(string_.capacity(), std::max(len, hi)));
+
+        char_type* base = const_cast<char_type*>(string_.data());
+        if (mode_ & ios_base::in)
+            this->setg(base, base + goff, base + gend);
+        else
+            this->setg(base + hi, base + hi, base + hi);
+        pbump_(base, base + string_.size(), poff);
+    }
+
     template <class CharT, class Traits, class Alloc>
     inline typename basic_stringbuf<CharT, Traits, Alloc>::int_type
     basic_stringbuf<CharT, Traits, Alloc>::
@@ -700,7 +1054,17 @@ namespace ard
         const bool testin = mode_ & ios_base::in;
         const bool testout = mode_ & ios_base::out;
         char_type* endg = base + string_.size();
-        char_type* endp = base + string_.capacity();
+
+        if (testout && base == string_.data()) {
+            // Output goes up to the capacity. The string is sized to
+            // it, so the content past size() can be moved out with it.
+            // The content ends at max(pptr(), egptr()).
+            const size_type len = string_.size();
+            string_.resize(string_.capacity());
+            base = const_cast<char_type*>(string_.data());
+            endg = base + len;
+        }
+        char_type* endp = base + string_.size();
 
         if (base != string_.data()) {
             // setbuf: i == size of buffer area (string_.size() == 0)
@@ -739,5 +1103,11 @@ namespace ard
     using ostringstream = basic_ostringstream<char>;
     using stringstream = basic_stringstream<char>;
 
+    template <std::size_t N>
+    using small_stringbuf = basic_small_stringbuf<N, char>;
+
+    template <std::size_t N>
+    using small_ostringstream = basic_small_ostringstream<N, char>;
+
 } // namespace ard
 
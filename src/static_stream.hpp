@@ -0,0 +1,931 @@
+// Copyright (C) 2019 Vladimir Talybin.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+#include <string>
+#include <iostream.hpp>
+#include <serstream.hpp>
+
+// Streams over a stream buffer type known at compile time. The buffer
+// has no virtual functions, so sputc() and the like inline together
+// with overflow() into the call site and no vtables are generated for
+// the buffers. Formatting and parsing are done by num_put and num_get
+// as for the other streams.
+namespace ard
+{
+    // Stream buffer dispatched at compile time (CRTP). Derived hides
+    // the protected functions it implements (overflow, underflow,
+    // uflow, xsputn, xsgetn, sync, showmanyc, xsputreserve and
+    // xsgetfill, see basic_streambuf) and declares the base a friend.
+    template <class Derived, class CharT, class Traits = std::char_traits<CharT>>
+    struct static_streambuf
+    {
+        using char_type = CharT;
+        using traits_type = Traits;
+        using int_type = typename traits_type::int_type;
+
+    protected:
+        char_type* in_beg_  = nullptr;  // Start of get area
+        char_type* in_cur_  = nullptr;  // Current read area
+        char_type* in_end_  = nullptr;  // End of get area
+        char_type* out_beg_ = nullptr;  // Start of put area
+        char_type* out_cur_ = nullptr;  // Current put area
+        char_type* out_end_ = nullptr;  // End of put area
+
+    public:
+        //
+        // Get area
+        //
+
+        std::streamsize in_avail()
+        {
+            const std::streamsize ret = this->egptr() - this->gptr();
+            return ret ? ret : derived_().showmanyc();
+        }
+
+        int_type snextc()
+        {
+            int_type ret = traits_type::eof();
+            if (!traits_type::eq_int_type(this->sbumpc(), ret))
+                ret = this->sgetc();
+            return ret;
+        }
+
+        int_type sbumpc()
+        {
+            if (this->gptr() < this->egptr()) {
+                const int_type ret = traits_type::to_int_type(*this->gptr());
+                this->gbump(1);
+                return ret;
+            }
+            return derived_().uflow();
+        }
+
+        int_type sgetc()
+        {
+            return this->gptr() < this->egptr() ?
+                traits_type::to_int_type(*this->gptr()) : derived_().underflow();
+        }
+
+        std::streamsize sgetn(char_type* s, std::streamsize n)
+        { return derived_().xsgetn(s, n); }
+
+        int_type sungetc()
+        {
+            if (this->eback() < this->gptr()) {
+                this->gbump(-1);
+                return traits_type::to_int_type(*this->gptr());
+            }
+            return traits_type::eof();
+        }
+
+        // See basic_streambuf::sgetavail()
+        std::streamsize sgetavail() const
+        { return this->egptr() - this->gptr(); }
+
+        // See basic_streambuf::sgetfill()
+        std::streamsize sgetfill(std::streamsize k)
+        {
+            const std::streamsize n = this->egptr() - this->gptr();
+            return n >= k ? n : derived_().xsgetfill(k);
+        }
+
+        void sgetconsume(std::streamsize n)
+        { this->gbump(n); }
+
+        //
+        // Put area
+        //
+
+        int_type sputc(char_type c)
+        {
+            if (this->pptr() < this->epptr()) {
+                *this->pptr() = c;
+                this->pbump(1);
+                return traits_type::to_int_type(c);
+            }
+            return derived_().overflow(traits_type::to_int_type(c));
+        }
+
+        std::streamsize sputn(const char_type* s, std::streamsize n)
+        { return derived_().xsputn(s, n); }
+
+        // See basic_streambuf::sputreserve()
+        char_type* sputreserve(std::streamsize n)
+        {
+            if (this->epptr() - this->pptr() >= n)
+                return this->pptr();
+            return derived_().xsputreserve(n);
+        }
+
+        void sputcommit(std::streamsize n)
+        { this->pbump(n); }
+
+        int pubsync()
+        { return derived_().sync(); }
+
+        //
+        // Get and put area access
+        //
+
+        char_type* eback() const
+        { return in_beg_; }
+
+        char_type* gptr() const
+        { return in_cur_; }
+
+        char_type* egptr() const
+        { return in_end_; }
+
+        void gbump(int n)
+        { in_cur_ += n; }
+
+        void setg(char_type* gbeg, char_type* gnext, char_type* gend)
+        {
+            in_beg_ = gbeg;
+            in_cur_ = gnext;
+            in_end_ = gend;
+        }
+
+        char_type* pbase() const
+        { return out_beg_; }
+
+        char_type* pptr() const
+        { return out_cur_; }
+
+        char_type* epptr() const
+        { return out_end_; }
+
+        void pbump(int n)
+        { out_cur_ += n; }
+
+        void setp(char_type* pbeg, char_type* pend)
+        {
+            out_beg_ = out_cur_ = pbeg;
+            out_end_ = pend;
+        }
+
+    protected:
+        static_streambuf() = default;
+
+        static_streambuf(const static_streambuf&) = delete;
+        static_streambuf& operator=(const static_streambuf&) = delete;
+
+        //
+        // Defaults, hidden by Derived
+        //
+
+        int sync()
+        { return 0; }
+
+        std::streamsize showmanyc()
+        { return 0; }
+
+        int_type underflow()
+        { return traits_type::eof(); }
+
+        int_type uflow()
+        {
+            int_type ret = derived_().underflow();
+            if (!traits_type::eq_int_type(ret, traits_type::eof()))
+                this->gbump(1);
+            return ret;
+        }
+
+        std::streamsize xsgetn(char_type* s, std::streamsize n);
+
+        std::streamsize xsgetfill(std::streamsize)
+        {
+            if (this->gptr() == this->egptr())
+                derived_().underflow();
+            return this->egptr() - this->gptr();
+        }
+
+        int_type overflow(int_type = traits_type::eof())
+        { return traits_type::eof(); }
+
+        std::streamsize xsputn(const char_type* s, std::streamsize n);
+
+        char_type* xsputreserve(std::streamsize)
+        { return nullptr; }
+
+    private:
+        Derived& derived_()
+        { return static_cast<Derived&>(*this); }
+    };
+
+    // Stream buffer over Arduino Stream with ON characters of output
+    // and IN characters of input buffer, unbuffered if zero. The
+    // counterpart of basic_serialbuf, sharing its device code.
+    template <size_t ON, size_t IN, class CharT,
+              class Traits = std::char_traits<CharT>>
+    struct basic_static_serialbuf
+    : serial_device<static_streambuf<basic_static_serialbuf<ON, IN, CharT, Traits>, CharT, Traits>>
+    {
+        using char_type = CharT;
+        using traits_type = Traits;
+        using serial_type = ::Stream;
+
+        using int_type = typename traits_type::int_type;
+        using streambuf_type = static_streambuf<basic_static_serialbuf, char_type, traits_type>;
+        using device_type = serial_device<streambuf_type>;
+
+    protected:
+        friend streambuf_type;
+
+        char_type obuf_arr_[ON ? ON : 1];
+        char_type ibuf_arr_[IN ? IN : 1];
+
+    public:
+        explicit basic_static_serialbuf(serial_type& ser,
+            serial_flush policy = serial_flush::full)
+        : device_type(ser)
+        {
+            this->flush_ = policy;
+            if (ON) {
+                this->obuf_ = obuf_arr_;
+                this->obuf_end_ = obuf_arr_ + ON;
+                this->obuf_pptr_(obuf_arr_);
+            }
+            if (IN) {
+                this->ibuf_ = ibuf_arr_;
+                this->ibuf_end_ = ibuf_arr_ + IN;
+            }
+            this->setg(ibuf_arr_, ibuf_arr_, ibuf_arr_);
+        }
+
+        // Writes out whatever is left in the output buffer
+        ~basic_static_serialbuf()
+        { this->drain_(); }
+
+    protected:
+        // Write out the output buffer. Returns 0 on success, -1 otherwise.
+        int sync()
+        { return ON ? this->drain_() : 0; }
+
+        std::streamsize showmanyc()
+        { return this->showmanyc_(); }
+
+        // Without an output buffer straight to the device, decided at
+        // compile time so that it inlines into the call site
+        int_type overflow(int_type c = traits_type::eof())
+        {
+            if (!ON && !traits_type::eq_int_type(c, traits_type::eof())) {
+                this->serial_.write(c);
+                return c;
+            }
+            return this->overflow_(c);
+        }
+
+        std::streamsize xsputn(const char_type* s, std::streamsize n)
+        {
+            if (!ON)
+                return this->serial_.write((const uint8_t*)s, n);
+            return this->xsputn_(s, n);
+        }
+
+        char_type* xsputreserve(std::streamsize n)
+        { return ON ? this->xsputreserve_(n) : nullptr; }
+
+        int_type underflow()
+        { return this->underflow_(); }
+
+        int_type uflow()
+        { return this->uflow_(); }
+
+        std::streamsize xsgetfill(std::streamsize k)
+        {
+            if (!IN)
+                return streambuf_type::xsgetfill(k);
+            return this->xsgetfill_(k);
+        }
+
+        std::streamsize xsgetn(char_type* s, std::streamsize n)
+        { return this->xsgetn_(s, n); }
+    };
+
+    // Stream buffer over a string. Output is always appended to the
+    // string and input reads what was written, there is no seeking.
+    // The string is kept at its capacity, the content ends at pptr().
+    template <class CharT, class Traits = std::char_traits<CharT>,
+              class Alloc = std::allocator<CharT>>
+    struct basic_static_stringbuf
+    : static_streambuf<basic_static_stringbuf<CharT, Traits, Alloc>, CharT, Traits>
+    {
+        using char_type = CharT;
+        using traits_type = Traits;
+        using allocator_type = Alloc;
+
+        using int_type = typename traits_type::int_type;
+        using streambuf_type = static_streambuf<basic_static_stringbuf, char_type, traits_type>;
+        using string_type = std::basic_string<char_type, traits_type, allocator_type>;
+        using size_type = typename string_type::size_type;
+
+    protected:
+        friend streambuf_type;
+
+        string_type string_;
+
+    public:
+        basic_static_stringbuf()
+        { sync_(0, 0); }
+
+        explicit basic_static_stringbuf(const string_type& s)
+        : string_(s)
+        { sync_(0, s.size()); }
+
+        // Copy of the content
+        string_type str() const
+        { return string_type(this->pbase(), this->pptr()); }
+
+        // New content, read from the start
+        void str(const string_type& s)
+        {
+            string_ = s;
+            sync_(0, s.size());
+        }
+
+    protected:
+        std::streamsize showmanyc()
+        {
+            update_egptr_();
+            const std::streamsize ret = this->egptr() - this->gptr();
+            return ret ? ret : -1;
+        }
+
+        int_type underflow()
+        {
+            update_egptr_();
+            return this->gptr() < this->egptr() ?
+                traits_type::to_int_type(*this->gptr()) : traits_type::eof();
+        }
+
+        std::streamsize xsgetfill(std::streamsize)
+        {
+            update_egptr_();
+            return this->egptr() - this->gptr();
+        }
+
+        int_type overflow(int_type c = traits_type::eof())
+        {
+            if (traits_type::eq_int_type(c, traits_type::eof()))
+                return traits_type::not_eof(c);
+            grow_(1);
+            *this->pptr() = traits_type::to_char_type(c);
+            this->pbump(1);
+            return c;
+        }
+
+        std::streamsize xsputn(const char_type* s, std::streamsize n)
+        {
+            grow_(n);
+            traits_type::copy(this->pptr(), s, n);
+            this->pbump(n);
+            return n;
+        }
+
+        char_type* xsputreserve(std::streamsize n)
+        {
+            grow_(n);
+            return this->pptr();
+        }
+
+        // Input reaches up to what was written
+        void update_egptr_()
+        {
+            if (this->egptr() < this->pptr())
+                this->setg(this->eback(), this->gptr(), this->pptr());
+        }
+
+        // Room for at least n more characters after pptr()
+        void grow_(size_type n)
+        {
+            const size_type len = this->pptr() - this->pbase();
+            if (size_type(this->epptr() - this->pptr()) >= n)
+                return;
+
+            // NB: Start at 64 characters and double, see basic_stringbuf
+            const size_type gpos = this->gptr() - this->eback();
+            const size_type gend = this->egptr() - this->eback();
+            string_.resize(std::max(std::max(len + n, 2 * string_.size()), size_type(64)));
+            char_type* base = &string_[0];
+            this->setg(base, base + gpos, base + gend);
+            this->setp(base, base + string_.size());
+            this->pbump(len);
+        }
+
+        // Get area at gpos, len characters of content
+        void sync_(size_type gpos, size_type len)
+        {
+            string_.resize(string_.capacity());
+            char_type* base = &string_[0];
+            this->setg(base, base + gpos, base + len);
+            this->setp(base, base + string_.size());
+            this->pbump(len);
+        }
+    };
+
+    // Output iterator over a static_streambuf
+    template <class Buf>
+    struct static_ostreambuf_iterator
+    : std::iterator<std::output_iterator_tag, void, void, void, void>
+    {
+        using char_type = typename Buf::char_type;
+        using traits_type = typename Buf::traits_type;
+        using streambuf_type = Buf;
+
+    private:
+        streambuf_type* sbuf_;
+        bool failed_;
+
+    public:
+        static_ostreambuf_iterator(streambuf_type* s) noexcept
+        : sbuf_(s)
+        , failed_(!sbuf_)
+        { }
+
+        static_ostreambuf_iterator& operator=(char_type c)
+        {
+            if (!failed_ &&
+                traits_type::eq_int_type(sbuf_->sputc(c), traits_type::eof()))
+            {
+                failed_ = true;
+            }
+            return *this;
+        }
+
+        static_ostreambuf_iterator& operator*()
+        { return *this; }
+
+        static_ostreambuf_iterator& operator++(int)
+        { return *this; }
+
+        static_ostreambuf_iterator& operator++()
+        { return *this; }
+
+        bool failed() const noexcept
+        { return failed_; }
+
+        static_ostreambuf_iterator& put_(const char_type* ws, std::streamsize len)
+        {
+            if (!failed_ && sbuf_->sputn(ws, len) != len)
+                failed_ = true;
+            return *this;
+        }
+
+        // See ostreambuf_iterator::reserve_()
+        char_type* reserve_(std::streamsize len)
+        { return failed_ ? nullptr : sbuf_->sputreserve(len); }
+
+        void commit_(std::streamsize len)
+        { sbuf_->sputcommit(len); }
+    };
+
+    // Input iterator over a static_streambuf
+    template <class Buf>
+    struct static_istreambuf_iterator
+    : std::iterator<std::input_iterator_tag, typename Buf::char_type,
+                    typename Buf::traits_type::off_type,
+                    typename Buf::char_type*, typename Buf::char_type>
+    {
+        using char_type = typename Buf::char_type;
+        using traits_type = typename Buf::traits_type;
+        using int_type = typename traits_type::int_type;
+        using streambuf_type = Buf;
+
+    private:
+        mutable streambuf_type* sbuf_;
+        mutable int_type c_;
+
+    public:
+        // End of stream iterator
+        constexpr static_istreambuf_iterator() noexcept
+        : sbuf_(nullptr)
+        , c_(traits_type::eof())
+        { }
+
+        static_istreambuf_iterator(streambuf_type* s) noexcept
+        : sbuf_(s)
+        , c_(traits_type::eof())
+        { }
+
+        char_type operator*() const
+        { return traits_type::to_char_type(get_()); }
+
+        static_istreambuf_iterator& operator++()
+        {
+            if (sbuf_ && !at_eof_()) {
+                sbuf_->sbumpc();
+                c_ = traits_type::eof();
+            }
+            return *this;
+        }
+
+        static_istreambuf_iterator operator++(int)
+        {
+            static_istreambuf_iterator old = *this;
+            if (sbuf_ && !at_eof_()) {
+                old.c_ = sbuf_->sbumpc();
+                c_ = traits_type::eof();
+            }
+            return old;
+        }
+
+        bool equal(const static_istreambuf_iterator& b) const
+        { return at_eof_() == b.at_eof_(); }
+
+        friend bool operator==(const static_istreambuf_iterator& a,
+                               const static_istreambuf_iterator& b)
+        { return a.equal(b); }
+
+        friend bool operator!=(const static_istreambuf_iterator& a,
+                               const static_istreambuf_iterator& b)
+        { return !a.equal(b); }
+
+    private:
+        int_type get_() const
+        {
+            const int_type eof = traits_type::eof();
+            int_type ret = eof;
+            if (sbuf_) {
+                if (!traits_type::eq_int_type(c_, eof))
+                    ret = c_;
+                else if (!traits_type::eq_int_type((ret = sbuf_->sgetc()), eof))
+                    c_ = ret;
+                else
+                    sbuf_ = nullptr;
+            }
+            return ret;
+        }
+
+        bool at_eof_() const
+        { return traits_type::eq_int_type(get_(), traits_type::eof()); }
+    };
+
+    // State, format and buffer of a static stream, the counterpart
+    // of basic_ios without tie()
+    template <class Buf>
+    struct static_ios : ios_state<Buf>
+    {
+    protected:
+        explicit static_ios(Buf& sb)
+        { this->init(&sb); }
+    };
+
+    // Output stream over the stream buffer type Buf. Formatting, padding
+    // and state handling are shared with basic_ostream.
+    template <class Buf>
+    struct static_ostream : static_ios<Buf>
+    {
+        using char_type = typename Buf::char_type;
+        using traits_type = typename Buf::traits_type;
+        using int_type = typename traits_type::int_type;
+
+        using streambuf_type = Buf;
+        using ostream_type = static_ostream<Buf>;
+        using iterator = static_ostreambuf_iterator<Buf>;
+        using num_put_type = num_put<char_type, iterator>;
+
+        explicit static_ostream(streambuf_type& sb)
+        : static_ios<Buf>(sb)
+        { }
+
+        // Safe prefix/suffix operations, as basic_ostream::sentry
+        // without tie()
+        struct sentry
+        {
+            explicit sentry(ostream_type& os)
+            : ok_(ostream_prefix(os))
+            , os_(os)
+            { }
+
+            ~sentry()
+            { ostream_unitbuf(os_); }
+
+            explicit operator bool() const
+            { return ok_; }
+
+        private:
+            bool ok_;
+            ostream_type& os_;
+        };
+
+        //
+        // Interface for manipulators
+        //
+
+        ostream_type& operator<<(ostream_type& (*pf)(ostream_type&))
+        { return pf(*this); }
+
+        ostream_type& operator<<(ios_base& (*pf)(ios_base&))
+        {
+            pf(*this);
+            return *this;
+        }
+
+        //
+        // Inserters
+        //
+
+        ostream_type& operator<<(long n)
+        { return ostream_insert_num(*this, n); }
+
+        ostream_type& operator<<(unsigned long n)
+        { return ostream_insert_num(*this, n); }
+
+        ostream_type& operator<<(bool n)
+        { return ostream_insert_num(*this, n); }
+
+        ostream_type& operator<<(short n)
+        {
+            const ios_base::fmtflags fmt = this->flags() & ios_base::basefield;
+            if (fmt == ios_base::oct || fmt == ios_base::hex)
+                return ostream_insert_num(*this, static_cast<long>(static_cast<unsigned short>(n)));
+            return ostream_insert_num(*this, static_cast<long>(n));
+        }
+
+        ostream_type& operator<<(unsigned short n)
+        { return ostream_insert_num(*this, static_cast<unsigned long>(n)); }
+
+        ostream_type& operator<<(int n)
+        {
+            const ios_base::fmtflags fmt = this->flags() & ios_base::basefield;
+            if (fmt == ios_base::oct || fmt == ios_base::hex)
+                return ostream_insert_num(*this, static_cast<long>(static_cast<unsigned int>(n)));
+            return ostream_insert_num(*this, static_cast<long>(n));
+        }
+
+        ostream_type& operator<<(unsigned int n)
+        { return ostream_insert_num(*this, static_cast<unsigned long>(n)); }
+
+        ostream_type& operator<<(long long n)
+        { return ostream_insert_num(*this, n); }
+
+        ostream_type& operator<<(unsigned long long n)
+        { return ostream_insert_num(*this, n); }
+
+        ostream_type& operator<<(double f)
+        { return ostream_insert_num(*this, f); }
+
+        ostream_type& operator<<(float f)
+        { return ostream_insert_num(*this, f); }
+
+        ostream_type& operator<<(long double f)
+        { return ostream_insert_num(*this, f); }
+
+        ostream_type& operator<<(const void* p)
+        { return ostream_insert_num(*this, p); }
+
+        //
+        // Unformatted Output Functions
+        //
+
+        ostream_type& put(char_type c)
+        { return ostream_put(*this, c); }
+
+        ostream_type& write(const char_type* s, std::streamsize n)
+        {
+            sentry cerb(*this);
+            if (cerb)
+                ostream_write(*this, s, n);
+            return *this;
+        }
+
+        ostream_type& flush()
+        { return ostream_flush(*this); }
+    };
+
+    // Input stream over the stream buffer type Buf. Parsing and state
+    // handling are shared with basic_istream.
+    template <class Buf>
+    struct static_istream : static_ios<Buf>
+    {
+        using char_type = typename Buf::char_type;
+        using traits_type = typename Buf::traits_type;
+        using int_type = typename traits_type::int_type;
+
+        using streambuf_type = Buf;
+        using istream_type = static_istream<Buf>;
+        using iterator = static_istreambuf_iterator<Buf>;
+        using num_get_type = num_get<char_type, iterator>;
+
+    protected:
+        std::streamsize gcount_ = 0;
+
+    public:
+        explicit static_istream(streambuf_type& sb)
+        : static_ios<Buf>(sb)
+        { }
+
+        // Skips white space, as basic_istream::sentry without tie()
+        struct sentry
+        {
+            explicit sentry(istream_type& is, bool noskipws = false)
+            : ok_(istream_prefix(is, noskipws))
+            { }
+
+            explicit operator bool() const
+            { return ok_; }
+
+        private:
+            bool ok_;
+        };
+
+        //
+        // Interface for manipulators
+        //
+
+        istream_type& operator>>(istream_type& (*pf)(istream_type&))
+        { return pf(*this); }
+
+        istream_type& operator>>(ios_base& (*pf)(ios_base&))
+        {
+            pf(*this);
+            return *this;
+        }
+
+        //
+        // Arithmetic extractors
+        //
+
+        istream_type& operator>>(bool& n)
+        { return istream_extract_num(*this, n); }
+
+        istream_type& operator>>(short& n)
+        { return istream_extract_narrow(*this, n); }
+
+        istream_type& operator>>(unsigned short& n)
+        { return istream_extract_num(*this, n); }
+
+        istream_type& operator>>(int& n)
+        { return istream_extract_narrow(*this, n); }
+
+        istream_type& operator>>(unsigned int& n)
+        { return istream_extract_num(*this, n); }
+
+        istream_type& operator>>(long& n)
+        { return istream_extract_num(*this, n); }
+
+        istream_type& operator>>(unsigned long& n)
+        { return istream_extract_num(*this, n); }
+
+        istream_type& operator>>(long long& n)
+        { return istream_extract_num(*this, n); }
+
+        istream_type& operator>>(unsigned long long& n)
+        { return istream_extract_num(*this, n); }
+
+        istream_type& operator>>(float& f)
+        { return istream_extract_num(*this, f); }
+
+        istream_type& operator>>(double& f)
+        { return istream_extract_num(*this, f); }
+
+        istream_type& operator>>(long double& f)
+        { return istream_extract_num(*this, f); }
+
+        istream_type& operator>>(void*& p)
+        { return istream_extract_num(*this, p); }
+
+        //
+        // Unformatted Input Functions
+        //
+
+        std::streamsize gcount() const
+        { return gcount_; }
+
+        int_type get()
+        { return istream_get(*this, gcount_); }
+
+        istream_type& get(char_type& c)
+        { return istream_get(*this, c, gcount_); }
+
+        int_type peek()
+        { return istream_peek(*this, gcount_); }
+
+        istream_type& read(char_type* s, std::streamsize n)
+        { return istream_read(*this, s, n, gcount_); }
+
+        istream_type& ignore(std::streamsize n = 1, int_type delim = traits_type::eof())
+        { return istream_ignore(*this, n, delim, gcount_); }
+    };
+
+
+    //
+    // Methods
+    //
+
+    template <class Derived, class CharT, class Traits>
+    inline std::streamsize static_streambuf<Derived, CharT, Traits>::
+    xsgetn(char_type* s, std::streamsize n)
+    {
+        std::streamsize ret = 0;
+        while (ret < n) {
+            const std::streamsize buf_len = this->egptr() - this->gptr();
+            if (buf_len) {
+                const std::streamsize len = std::min(buf_len, n - ret);
+                traits_type::copy(s, this->gptr(), len);
+                ret += len;
+                s += len;
+                this->gbump(len);
+            }
+            if (ret < n) {
+                const int_type c = derived_().uflow();
+                if (traits_type::eq_int_type(c, traits_type::eof()))
+                    break;
+                traits_type::assign(*s++, traits_type::to_char_type(c));
+                ++ret;
+            }
+        }
+        return ret;
+    }
+
+    template <class Derived, class CharT, class Traits>
+    inline std::streamsize static_streambuf<Derived, CharT, Traits>::
+    xsputn(const char_type* s, std::streamsize n)
+    {
+        std::streamsize ret = 0;
+        while (ret < n) {
+            const std::streamsize buf_len = this->epptr() - this->pptr();
+            if (buf_len) {
+                const std::streamsize len = std::min(buf_len, n - ret);
+                traits_type::copy(this->pptr(), s, len);
+                ret += len;
+                s += len;
+                this->pbump(len);
+            }
+            if (ret < n) {
+                const int_type c = derived_().overflow(traits_type::to_int_type(*s));
+                if (traits_type::eq_int_type(c, traits_type::eof()))
+                    break;
+                ++ret;
+                ++s;
+            }
+        }
+        return ret;
+    }
+
+    //
+    // Non-member functions
+    //
+
+    template <class Buf>
+    inline static_ostream<Buf>&
+    operator<<(static_ostream<Buf>& out, typename Buf::char_type c)
+    { return ostream_insert(out, &c, 1); }
+
+    template <class Buf>
+    inline static_ostream<Buf>&
+    operator<<(static_ostream<Buf>& out, const typename Buf::char_type* s)
+    {
+        if (!s)
+            out.setstate(ios_base::badbit);
+        else
+            ostream_insert(out, s, Buf::traits_type::length(s));
+        return out;
+    }
+
+    template <class Buf>
+    inline static_ostream<Buf>& endl(static_ostream<Buf>& os)
+    { return os.put(os.widen('\n')).flush(); }
+
+    template <class Buf>
+    inline static_ostream<Buf>& ends(static_ostream<Buf>& os)
+    { return os.put(typename Buf::char_type()); }
+
+    template <class Buf>
+    inline static_ostream<Buf>& flush(static_ostream<Buf>& os)
+    { return os.flush(); }
+
+    template <class Buf>
+    inline static_istream<Buf>&
+    operator>>(static_istream<Buf>& in, typename Buf::char_type& c)
+    { return istream_extract_char(in, c); }
+
+    // Skips whitespace regardless of skipws
+    template <class Buf>
+    inline static_istream<Buf>& ws(static_istream<Buf>& in)
+    { return istream_ws(in); }
+
+    //
+    // Alias
+    //
+
+    template <std::size_t ON = 0, std::size_t IN = 0>
+    using static_serialbuf = basic_static_serialbuf<ON, IN, char>;
+
+    using static_stringbuf = basic_static_stringbuf<char>;
+
+} // namespace ard
@@ -118,6 +118,26 @@ namespace ard
         std::streamsize sgetn(char_type* s, std::streamsize n)
         { return this->xsgetn(s, n); }
 
+        // Extension. Number of characters buffered in the get area,
+        // they are [gptr(), gptr() + sgetavail()). Parse them in place
+        // and consume what was used with sgetconsume().
+        std::streamsize sgetavail() const
+        { return this->egptr() - this->gptr(); }
+
+        // Extension. Tries to have at least k characters buffered in
+        // the get area, refilling it with xsgetfill() if needed. Returns
+        // sgetavail(), which is less than k at the end of input or if
+        // the buffer cannot hold k characters (0 if unbuffered).
+        std::streamsize sgetfill(std::streamsize k)
+        {
+            const std::streamsize n = this->egptr() - this->gptr();
+            return n >= k ? n : this->xsgetfill(k);
+        }
+
+        // Extension. Consumes n characters of the get area
+        void sgetconsume(std::streamsize n)
+        { this->gbump(n); }
+
         //
         // Putback
         //
@@ -162,6 +182,31 @@ namespace ard
         std::streamsize sputn(const char_type* s, std::streamsize n)
         { return this->xsputn(s, n); }
 
+        // Extension. Returns pptr() with room for at least n characters
+        // after it, made by xsputreserve() if needed, or nullptr if
+        // there cannot be that much room. Write the characters there
+        // and output them with sputcommit().
+        char_type* sputreserve(std::streamsize n)
+        {
+            if (this->epptr() - this->pptr() >= n)
+                return this->pptr();
+            return this->xsputreserve(n);
+        }
+
+        // Extension. Outputs n characters written at pptr()
+        void sputcommit(std::streamsize n)
+        { this->pbump(n); }
+
+        // Extension. Nonzero if there is output that pubsync() would
+        // pass on, the characters in the put area. Without a put area
+        // it is up to xsputwaiting().
+        std::streamsize sputwaiting()
+        {
+            if (this->pbase())
+                return this->pptr() - this->pbase();
+            return this->xsputwaiting();
+        }
+
     protected:
         // Base constructor
         basic_streambuf() = default;
@@ -257,6 +302,15 @@ namespace ard
         // Multiple character extraction
         virtual std::streamsize xsgetn(char_type* s, std::streamsize n);
 
+        // Extension. Makes at least k characters available in the get
+        // area if possible, returns how many there are
+        virtual std::streamsize xsgetfill(std::streamsize)
+        {
+            if (this->gptr() == this->egptr())
+                this->underflow();
+            return this->egptr() - this->gptr();
+        }
+
         // Fetches more data from the controlled sequence
         virtual int_type underflow()
         { return traits_type::eof(); }
@@ -292,6 +346,16 @@ namespace ard
         virtual int_type overflow(int_type c  = traits_type::eof())
         { return traits_type::eof(); }
 
+        // Extension. Makes room for n characters in the put area and
+        // returns pptr(), or nullptr if it cannot
+        virtual char_type* xsputreserve(std::streamsize)
+        { return nullptr; }
+
+        // Extension. Output waiting outside of a put area, -1 if not
+        // known, so that sputwaiting() never hides a needed sync()
+        virtual std::streamsize xsputwaiting()
+        { return -1; }
+
 
         basic_streambuf(const basic_streambuf&) = default;
 
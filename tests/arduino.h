@@ -0,0 +1,112 @@
+// Copyright (C) 2019 Vladimir Talybin.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+// Stand-ins for the parts of the Arduino core the library uses, to
+// build the tests on the host. Include before the library headers.
+
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <deque>
+#include <string>
+
+struct Print
+{
+    virtual ~Print()
+    { }
+
+    virtual size_t write(uint8_t) = 0;
+
+    virtual size_t write(const uint8_t* s, size_t n)
+    {
+        size_t i = 0;
+        while (i < n && write(s[i]))
+            ++i;
+        return i;
+    }
+
+    virtual void flush()
+    { }
+};
+
+struct Stream : Print
+{
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+
+    void setTimeout(unsigned long ms)
+    { timeout_ = ms; }
+
+    size_t readBytes(char* s, size_t n)
+    {
+        size_t i = 0;
+        for (int c; i < n && (c = timedRead()) >= 0; ++i)
+            s[i] = char(c);
+        return i;
+    }
+
+    size_t readBytes(uint8_t* s, size_t n)
+    { return readBytes(reinterpret_cast<char*>(s), n); }
+
+protected:
+    // There is no time on the host, input that is not there now
+    // never arrives
+    int timedRead()
+    { return read(); }
+
+    int timedPeek()
+    { return peek(); }
+
+    unsigned long timeout_ = 1000;
+};
+
+// Serial port over memory. Output is collected in out, input is
+// queued with feed().
+struct memory_serial : Stream
+{
+    std::string out;
+    std::deque<char> in;
+
+    size_t write(uint8_t c) override
+    {
+        out += char(c);
+        return 1;
+    }
+
+    size_t write(const uint8_t* s, size_t n) override
+    {
+        out.append(reinterpret_cast<const char*>(s), n);
+        return n;
+    }
+
+    int available() override
+    { return int(in.size()); }
+
+    int read() override
+    {
+        if (in.empty())
+            return -1;
+        const int c = static_cast<unsigned char>(in.front());
+        in.pop_front();
+        return c;
+    }
+
+    int peek() override
+    { return in.empty() ? -1 : static_cast<unsigned char>(in.front()); }
+
+    void feed(const std::string& s)
+    { in.insert(in.end(), s.begin(), s.end()); }
+};
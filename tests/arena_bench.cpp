@@ -0,0 +1,169 @@
+// Copyright (C) 2019 Vladimir Talybin.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+// Formatting messages into string streams that allocate from the
+// heap, a monotonic_arena reset after each cycle and a block_pool.
+// Each cycle formats 8 messages that are alive at the same time,
+// as a sketch sending a batch of readings. Heap allocations per
+// message are what fragments the heap of the target, the time is
+// the cost of the allocator on the host.
+//
+//   arena_bench [cycles]
+
+#include "arduino.h"
+#include <arena.hpp>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+    unsigned long long allocations = 0;
+    unsigned long long heap_bytes = 0;
+}
+
+void* operator new(size_t n)
+{
+    ++allocations;
+    heap_bytes += n;
+    if (void* p = malloc(n ? n : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept
+{ free(p); }
+
+void operator delete(void* p, size_t) noexcept
+{ free(p); }
+
+namespace
+{
+    const int messages = 8;
+
+    // One reading of a few tens of characters, longer every
+    // few messages to make the strings grow past 64 characters
+    template <class Stream>
+    void format(Stream& os, unsigned i)
+    {
+        os << "sensor=" << (i % 16) << " t=" << (i % 400) / 10.0
+           << " p=" << 1013 + int(i % 7) << " rssi=" << -int(i % 90);
+        if (i % 3 == 0)
+            os << " status=ok uptime=" << i * 1000ul << " fw=1.4.2";
+    }
+
+    struct result
+    {
+        double ns = 1e300;
+        unsigned long long allocs = 0;
+        unsigned long long bytes = 0;
+        unsigned long long chars = 0;
+    };
+
+    template <class Stream, class Make, class Reset>
+    result run(unsigned cycles, Make make, Reset reset)
+    {
+        result r;
+        for (int rep = 0; rep < 3; ++rep) {
+            const unsigned long long a0 = allocations, b0 = heap_bytes;
+            unsigned long long chars = 0;
+            const auto t0 = std::chrono::steady_clock::now();
+            for (unsigned c = 0; c < cycles; ++c) {
+                {
+                    alignas(Stream) char mem[messages][sizeof(Stream)];
+                    Stream* os[messages];
+                    for (int m = 0; m < messages; ++m) {
+                        os[m] = make(mem[m]);
+                        format(*os[m], c * messages + m);
+                    }
+                    for (int m = 0; m < messages; ++m) {
+                        chars += os[m]->view().size();
+                        os[m]->~Stream();
+                    }
+                }
+                reset();
+            }
+            const auto t1 = std::chrono::steady_clock::now();
+            const double ns = std::chrono::duration<double, std::nano>(t1 - t0).count();
+            if (ns < r.ns) {
+                r.ns = ns;
+                r.allocs = allocations - a0;
+                r.bytes = heap_bytes - b0;
+                r.chars = chars;
+            }
+        }
+        return r;
+    }
+
+    void print(const char* name, const result& r, unsigned cycles)
+    {
+        const double n = double(cycles) * messages;
+        printf("  %-8s %8.1f ns/msg %6.2f allocations/msg %8.1f heap bytes/msg (%.1f chars/msg)\n",
+               name, r.ns / n, r.allocs / n, r.bytes / n, r.chars / n);
+    }
+
+    ard::stringbuf_growth small_growth()
+    {
+        ard::stringbuf_growth g;
+        g.initial = 64;
+        return g;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const unsigned cycles = argc > 1 ? strtoul(argv[1], nullptr, 0) : 100000;
+    const ard::stringbuf_growth g = small_growth();
+
+    printf("%d messages per cycle, strings start at %zu characters\n",
+           messages, g.initial);
+
+    const result heap = run<ard::ostringstream>(cycles,
+        [&](void* p) {
+            auto* os = new (p) ard::ostringstream;
+            os->rdbuf()->growth(g);
+            return os;
+        },
+        [] { });
+    print("heap", heap, cycles);
+
+    static char arena_mem[4096];
+    ard::monotonic_arena arena(arena_mem, sizeof(arena_mem));
+    const result ar = run<ard::arena_ostringstream>(cycles,
+        [&](void* p) {
+            auto* os = new (p) ard::arena_ostringstream(ard::arena_allocator<char>(arena));
+            os->rdbuf()->growth(g);
+            return os;
+        },
+        [&] { arena.reset(); });
+    print("arena", ar, cycles);
+    printf("           peak %zu of %zu bytes, %zu misses\n",
+           arena.peak(), arena.capacity(), arena.misses());
+
+    // Blocks for the grown string of 128 characters and its null
+    static char pool_mem[4096];
+    ard::block_pool pool(pool_mem, sizeof(pool_mem), 160);
+    const result po = run<ard::pool_ostringstream>(cycles,
+        [&](void* p) {
+            auto* os = new (p) ard::pool_ostringstream(ard::pool_allocator<char>(pool));
+            os->rdbuf()->growth(g);
+            return os;
+        },
+        [] { });
+    print("pool", po, cycles);
+    printf("           peak %zu of %zu blocks of %zu bytes, %zu misses\n",
+           pool.peak(), pool.capacity(), pool.block_size(), pool.misses());
+}
@@ -0,0 +1,153 @@
+// Copyright (C) 2019 Vladimir Talybin.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+// Arena and pool memory resources and the allocator over them:
+// alignment, freeing the last allocation, block reuse and falling
+// back to the heap.
+
+#include "arduino.h"
+#include <arena.hpp>
+#include <cstdio>
+
+namespace
+{
+    int failures = 0;
+
+    void expect(bool ok, const char* what)
+    {
+        if (!ok) {
+            ++failures;
+            printf("FAILED: %s\n", what);
+        }
+    }
+
+    void arena()
+    {
+        alignas(16) char buf[64];
+        ard::monotonic_arena a(buf, sizeof(buf));
+
+        char* p1 = static_cast<char*>(a.allocate(1, 1));
+        char* p2 = static_cast<char*>(a.allocate(4, 4));
+        char* p3 = static_cast<char*>(a.allocate(2, 2));
+        char* p4 = static_cast<char*>(a.allocate(1, 16));
+        expect(p1 == buf && p2 == buf + 4 && p3 == buf + 8 && p4 == buf + 16,
+               "arena: padded to the alignment");
+        expect(a.used() == 17, "arena: used() counts the padding");
+
+        // Only the last allocation is freed
+        a.deallocate(p3, 2);
+        expect(a.used() == 17, "arena: not the last allocation");
+        a.deallocate(p4, 1);
+        expect(a.used() == 16, "arena: last allocation");
+        expect(a.allocate(1, 1) == buf + 16, "arena: reused after the last is freed");
+
+        expect(a.allocate(48, 1) == nullptr && a.misses() == 1, "arena: does not fit");
+        expect(a.allocate(46, 1) == buf + 17 && a.used() == 63, "arena: one byte left");
+        expect(a.allocate(1, 2) == nullptr && a.misses() == 2, "arena: padding takes the room");
+        expect(a.allocate(1, 1) == buf + 63 && a.used() == 64, "arena: fits exactly");
+
+        a.reset();
+        expect(a.used() == 0 && a.peak() == 64, "arena: reset() keeps the peak");
+        expect(a.allocate(8, 8) == buf, "arena: from the start after reset()");
+        expect(a.owns(buf) && a.owns(buf + 63) && !a.owns(buf + 64), "arena: owns()");
+    }
+
+    void pool()
+    {
+        alignas(max_align_t) char buf[8 * alignof(max_align_t) + 1];
+        const size_t align = alignof(max_align_t);
+
+        // Blocks are rounded up to the alignment, the buffer start too
+        ard::block_pool p(buf + 1, sizeof(buf) - 1, align + 1);
+        expect(p.block_size() == 2 * align, "pool: block size rounded up");
+        expect(p.capacity() == 3, "pool: blocks after aligning the start");
+
+        void* a = p.allocate(1, 1);
+        void* b = p.allocate(2 * align, align);
+        expect(a == buf + align && b == buf + 3 * align, "pool: blocks in order");
+        expect(p.allocate(2 * align + 1, 1) == nullptr && p.misses() == 1, "pool: too large");
+        expect(p.allocate(1, 2 * align) == nullptr && p.misses() == 2, "pool: over aligned");
+
+        // Freed blocks first, last freed first
+        p.deallocate(a, 1);
+        p.deallocate(b, 1);
+        expect(p.used() == 0, "pool: all freed");
+        expect(p.allocate(1, 1) == b && p.allocate(1, 1) == a, "pool: free list reused");
+        void* c = p.allocate(1, 1);
+        expect(c == buf + 5 * align && p.allocate(1, 1) == nullptr, "pool: all taken");
+        expect(p.peak() == 3 && p.misses() == 3, "pool: peak and misses");
+        expect(p.owns(c) && !p.owns(buf) && !p.owns(buf + 7 * align), "pool: owns()");
+
+        p.reset();
+        expect(p.used() == 0 && p.allocate(1, 1) == a, "pool: from the start after reset()");
+    }
+
+    void allocator()
+    {
+        alignas(16) char buf[32];
+        ard::monotonic_arena a(buf, sizeof(buf));
+        ard::arena_allocator<char> alloc(a);
+
+        char* in = alloc.allocate(16);
+        expect(a.owns(in), "allocator: from the arena");
+        char* out = alloc.allocate(64);
+        expect(out && !a.owns(out) && a.misses() == 1, "allocator: heap when it does not fit");
+        alloc.deallocate(out, 64);
+        alloc.deallocate(in, 16);
+        expect(a.used() == 0, "allocator: last allocation given back to the arena");
+
+        ard::arena_allocator<int> ints(alloc);
+        expect(ints == alloc && ints.resource() == &a, "allocator: rebound to the same arena");
+        int* i = ints.allocate(2);
+        expect(reinterpret_cast<uintptr_t>(i) % alignof(int) == 0 && a.owns(i),
+               "allocator: aligned for the type");
+        ints.deallocate(i, 2);
+
+        // A string outgrowing the arena moves to the heap
+        a.reset();
+        ard::arena_string s(alloc);
+        s.assign(20, 'a');
+        expect(a.owns(s.data()), "allocator: string in the arena");
+        s.append(40, 'b');
+        expect(!a.owns(s.data()) && s.size() == 60 && s[59] == 'b', "allocator: string on the heap");
+
+        // And so does a stream
+        a.reset();
+        ard::arena_ostringstream os(alloc);
+        ard::stringbuf_growth g;
+        g.initial = 16;
+        os.rdbuf()->growth(g);
+        os << "T=" << 21.5;
+        expect(a.owns(os.view().data()), "allocator: stream in the arena");
+        os << " P=1013 H=45 W=3.2 D=270";
+        expect(os.view() == "T=21.5 P=1013 H=45 W=3.2 D=270", "allocator: stream content");
+
+        char pool_buf[256];
+        ard::block_pool p(pool_buf, sizeof(pool_buf), 64);
+        ard::pool_ostringstream ps{ard::pool_allocator<char>(p)};
+        ps.rdbuf()->growth(g);
+        ps << "id=" << 7;
+        expect(p.used() == 1 && ps.view() == "id=7", "allocator: stream in a pool block");
+    }
+}
+
+int main()
+{
+    arena();
+    pool();
+    allocator();
+
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,199 @@
+// Copyright (C) 2019 Vladimir Talybin.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+// Output batches: unitbuf and tie() flushed once however the batches
+// nest, a bad stream left bad, and single characters written the way
+// they were before batches.
+
+#include "arduino.h"
+#include <ard-streams.h>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+namespace
+{
+    int failures = 0;
+
+    void expect(bool ok, const char* what)
+    {
+        if (!ok) {
+            ++failures;
+            printf("FAILED: %s\n", what);
+        }
+    }
+
+    // Buffered output collected in out, counting the syncs
+    struct sync_counter : ard::basic_streambuf<char>
+    {
+        std::string out;
+        int syncs = 0;
+        char buf[64];
+
+        sync_counter()
+        { this->setp(buf, buf + sizeof(buf)); }
+
+    protected:
+        int sync() override
+        {
+            ++syncs;
+            out.append(this->pbase(), this->pptr());
+            this->setp(buf, buf + sizeof(buf));
+            return 0;
+        }
+
+        int_type overflow(int_type c) override
+        {
+            sync();
+            if (!traits_type::eq_int_type(c, traits_type::eof()))
+                this->sputc(traits_type::to_char_type(c));
+            return traits_type::not_eof(c);
+        }
+    };
+
+    // Counts the writes of each kind
+    struct write_counter : memory_serial
+    {
+        int chars = 0;
+        int blocks = 0;
+
+        size_t write(uint8_t c) override
+        {
+            ++chars;
+            return memory_serial::write(c);
+        }
+
+        size_t write(const uint8_t* s, size_t n) override
+        {
+            ++blocks;
+            return memory_serial::write(s, n);
+        }
+    };
+
+    void unitbuf()
+    {
+        sync_counter sb;
+        ard::ostream out(&sb);
+        out << ard::unitbuf;
+
+        out << 1 << ' ' << 2 << '\n';
+        expect(sb.syncs == 4 && sb.out == "1 2\n", "unitbuf: a sync per insertion");
+
+        sb.syncs = 0;
+        {
+            ard::ostream::batch outer(out);
+            out << 3 << ' ';
+            {
+                ard::ostream::batch inner(out);
+                out << 4 << '\n';
+            }
+            expect(sb.syncs == 0, "unitbuf: no sync at the end of a nested batch");
+            out << 5 << '\n';
+        }
+        expect(sb.syncs == 1, "unitbuf: one sync at the end of the outer batch");
+        expect(sb.out == "1 2\n3 4\n5\n", "unitbuf: batched output");
+
+        // An explicit flush still goes through
+        sb.syncs = 0;
+        {
+            ard::ostream::batch b(out);
+            out << 6 << ard::endl;
+            expect(sb.syncs == 1, "unitbuf: endl in a batch");
+        }
+        expect(sb.syncs == 2 && sb.out == "1 2\n3 4\n5\n6\n", "unitbuf: after endl");
+    }
+
+    void tie()
+    {
+        sync_counter tied;
+        ard::ostream prompt(&tied);
+        sync_counter sb;
+        ard::ostream out(&sb);
+        out.tie(&prompt);
+
+        prompt << "> ";
+        {
+            ard::ostream::batch outer(out);
+            expect(tied.syncs == 1 && tied.out == "> ", "tie: flushed at the batch start");
+            out << 1;
+            prompt << "waiting";
+            {
+                ard::ostream::batch inner(out);
+                out << ' ' << 2;
+            }
+            out << '\n';
+        }
+        expect(tied.syncs == 1 && tied.out == "> ", "tie: not flushed again in the batch");
+
+        out << 3;
+        expect(tied.syncs == 2 && tied.out == "> waiting", "tie: flushed after the batch");
+    }
+
+    void bad()
+    {
+        // Bad before the batch
+        sync_counter sb;
+        ard::ostream out(&sb);
+        out << ard::unitbuf;
+        out.setstate(ard::ios_base::badbit);
+        {
+            ard::ostream::batch b(out);
+            expect(!b, "bad: batch reports the stream");
+            out << 1 << '\n';
+        }
+        expect(out.bad() && out.fail() && sb.out.empty(), "bad: nothing written");
+
+        // Bad in the middle, the same state as without a batch
+        char pbuf[4], bbuf[4];
+        ard::ospanstream plain(pbuf), batched(bbuf);
+        plain << "abc" << 'd' << 'e' << 1;
+        {
+            ard::ostream::batch b(batched);
+            expect(bool(b), "bad: batch on a good stream");
+            batched << "abc" << 'd' << 'e' << 1;
+        }
+        expect(batched.bad() && memcmp(bbuf, "abcd", 4) == 0, "bad: still bad after the batch");
+        expect(plain.rdstate() == batched.rdstate(), "bad: state as without a batch");
+    }
+
+    // A lone character to an unbuffered serial is a write of one
+    // character, buffered it waits in the put area
+    void single_char()
+    {
+        write_counter ser;
+        ard::oserialstream out(ser);
+        out << 'x' << "y" << 1;
+        expect(ser.out == "xy1" && ser.blocks == 3 && ser.chars == 0,
+               "char: unbuffered write(s, 1)");
+
+        write_counter bser;
+        char obuf[8];
+        ard::oserialstream bout(bser, obuf, sizeof(obuf));
+        bout << 'x';
+        expect(bser.out.empty() && bout.rdbuf()->sputwaiting() == 1, "char: buffered");
+        bout.flush();
+        expect(bser.out == "x" && bser.blocks == 1 && bser.chars == 0, "char: flushed");
+    }
+}
+
+int main()
+{
+    unitbuf();
+    tie();
+    bad();
+    single_char();
+
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,224 @@
+// Copyright (C) 2019 Vladimir Talybin.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+// Whitespace and character scans compared with a plain loop at every
+// offset and length, for every byte value, and ignore() and getline()
+// over input that is refilled while they scan. Built once for each
+// scan path the host has: AVX2, SSE2 and a word at a time.
+
+#include "arduino.h"
+#include <ard-streams.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <string>
+
+namespace
+{
+    int failures = 0;
+
+    // The case is offset, length and position for the scans, buffer
+    // size, count and position for ignore() and getline()
+    void expect(bool ok, const char* what, size_t a, size_t b, size_t pos)
+    {
+        if (!ok && ++failures <= 20)
+            printf("FAILED: %s, case %zu %zu %zu\n", what, a, b, pos);
+    }
+
+    const char* path()
+    {
+#if defined(__AVX2__)
+        return "AVX2";
+#elif defined(__SSE2__)
+        return "SSE2";
+#elif defined(__ARM_NEON)
+        return "NEON";
+#else
+        return "word at a time";
+#endif
+    }
+
+    const char* ref_find(const char* first, const char* last, bool wsp)
+    {
+        while (first != last && ard::is_wsp(*first) != wsp)
+            ++first;
+        return first;
+    }
+
+    // Whitespace and characters next to it in value, with and
+    // without the high bit
+    const unsigned char other[] = {
+        0x00, 0x08, 0x0e, 0x1f, 0x21, 'x', 0x7f, 0x80, 0x89, 0x8d, 0xa0, 0xff
+    };
+    const char spaces[] = " \t\n\v\f\r";
+
+    // One character in a run of the other kind, at every position of
+    // every range up to 96 characters at each of 32 alignments
+    void offsets()
+    {
+        const size_t size = 32 + 96;
+        char buf[size];
+        for (size_t off = 0; off < 32; ++off) {
+            for (size_t len = 0; off + len <= size && len <= 96; ++len) {
+                const char* first = buf + off;
+                const char* last = first + len;
+                for (size_t pos = 0; pos <= len; ++pos) {
+                    const size_t i = off + len + pos;
+
+                    // A space among other characters
+                    for (size_t k = 0; k < size; ++k)
+                        buf[k] = char(other[(k + i) % sizeof(other)]);
+                    if (pos < len)
+                        buf[off + pos] = spaces[i % 6];
+                    expect(ard::find_wsp(first, last) == first + pos,
+                           "find_wsp", off, len, pos);
+
+                    // Another character among spaces
+                    for (size_t k = 0; k < size; ++k)
+                        buf[k] = spaces[(k + i) % 6];
+                    if (pos < len)
+                        buf[off + pos] = char(other[i % sizeof(other)]);
+                    expect(ard::find_not_wsp(first, last) == first + pos,
+                           "find_not_wsp", off, len, pos);
+
+                    // A character among others, twice
+                    for (size_t k = 0; k < size; ++k)
+                        buf[k] = char('a' + (k + i) % 26);
+                    const char c = pos < len ? '#' : '$';
+                    if (pos < len) {
+                        buf[off + pos] = c;
+                        if (pos + 1 < len)
+                            buf[off + len - 1] = c;
+                    }
+                    expect(ard::find_char(first, last, c) == first + pos,
+                           "find_char", off, len, pos);
+                }
+            }
+        }
+    }
+
+    // Every byte value at every position of a 64 character range
+    void bytes()
+    {
+        char buf[64];
+        for (int b = 0; b < 256; ++b) {
+            const bool wsp = ard::is_wsp(char(b));
+            expect(wsp == (b == ' ' || (b >= '\t' && b <= '\r')), "is_wsp", 0, 1, b);
+            for (size_t pos = 0; pos < sizeof(buf); ++pos) {
+                memset(buf, 'x', sizeof(buf));
+                buf[pos] = char(b);
+                expect(ard::find_wsp(buf, buf + sizeof(buf)) ==
+                       ref_find(buf, buf + sizeof(buf), true), "find_wsp byte", 0, 64, pos);
+
+                memset(buf, ' ', sizeof(buf));
+                buf[pos] = char(b);
+                expect(ard::find_not_wsp(buf, buf + sizeof(buf)) ==
+                       ref_find(buf, buf + sizeof(buf), false), "find_not_wsp byte", 0, 64, pos);
+
+                memset(buf, 0, sizeof(buf));
+                buf[pos] = char(b);
+                expect(ard::find_char(buf, buf + sizeof(buf), char(b)) ==
+                       (b ? buf + pos : buf), "find_char byte", 0, 64, pos);
+            }
+        }
+    }
+
+    const std::string text = "abc;defgh;ij;;klmnopqrstuvwxyz;0123456789\n ;x";
+
+    // What ignore(n, delim) takes from text at p
+    std::streamsize ref_ignore(size_t p, std::streamsize n, int delim)
+    {
+        std::streamsize k = 0;
+        while (k < n && p + k < text.size()) {
+            if (text[p + k++] == delim)
+                break;
+        }
+        return k;
+    }
+
+    // Buffers of 1 to 9 characters and unbuffered, refilled
+    // while the get area is scanned
+    void ignore()
+    {
+        const std::streamsize max = std::numeric_limits<std::streamsize>::max();
+        const int delims[] = { ';', '\n', 'x', EOF, 0x100 + ';' };
+        char ibuf[9];
+        for (size_t bsize = 0; bsize <= sizeof(ibuf); ++bsize) {
+            for (int delim : delims) {
+                for (std::streamsize n = 0; n <= std::streamsize(text.size()) + 1; ++n) {
+                    const std::streamsize count = n > std::streamsize(text.size()) ? max : n;
+                    memory_serial ser;
+                    ser.feed(text.c_str());
+                    ard::iserialstream in(ser);
+                    in.rdbuf()->pubsetbuf(bsize ? ibuf : nullptr, bsize);
+
+                    // Start a bit into the text so the scans do not
+                    // begin at the buffer start
+                    size_t p = 2;
+                    in.ignore(2);
+                    while (in) {
+                        const std::streamsize want = ref_ignore(p, count, delim);
+                        in.ignore(count, delim);
+                        const bool at_end = count && p + want == text.size() &&
+                            (want == 0 || text[p + want - 1] != delim);
+                        expect(in.gcount() == want, "ignore: gcount", bsize, size_t(n), p);
+                        expect(in.eof() == at_end, "ignore: eof", bsize, size_t(n), p);
+                        p += want;
+                        if (!in)
+                            break;
+                        const int c = in.peek();
+                        expect(c == (p < text.size() ? text[p] : EOF),
+                               "ignore: next character", bsize, size_t(n), p);
+                        if (!count || p >= text.size())
+                            break;
+                    }
+                }
+            }
+
+            // getline() counts the delimiter too
+            memory_serial ser;
+            ser.feed(text.c_str());
+            ard::iserialstream in(ser);
+            in.rdbuf()->pubsetbuf(bsize ? ibuf : nullptr, bsize);
+            char line[32];
+            size_t p = 0;
+            while (in.getline(line, sizeof(line), ';')) {
+                const size_t end = std::min(text.find(';', p), text.size());
+                expect(std::string(line) == text.substr(p, end - p) &&
+                       in.gcount() == std::streamsize(end - p + (end < text.size())),
+                       "getline", bsize, 0, p);
+                p = std::min(end + 1, text.size());
+            }
+            expect(p == text.size() && in.eof(), "getline: to the end", bsize, 0, p);
+        }
+    }
+}
+
+int main()
+{
+#if defined(__AVX2__) && defined(__GNUC__)
+    if (!__builtin_cpu_supports("avx2")) {
+        printf("No AVX2 on this CPU\n");
+        return 77;
+    }
+#endif
+    offsets();
+    bytes();
+    ignore();
+
+    printf("%s: %d failures\n", path(), failures);
+    return failures ? 1 : 0;
+}
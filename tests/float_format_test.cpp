@@ -0,0 +1,114 @@
+// Copyright (C) 2019 Vladimir Talybin.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+// Checks that a float is formatted as the same characters as the
+// double it promotes to, in fixed, scientific, general and hex
+// notation, for every stride-th bit pattern.
+//
+//   float_format_test [stride [first [last]]]
+//
+// A stride of 1 covers all 2^32 floats. The range is split among the
+// hardware threads.
+
+#include "arduino.h"
+#include <sstream.hpp>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    const ard::ios_base::fmtflags formats[] = {
+        ard::ios_base::fixed,
+        ard::ios_base::scientific,
+        ard::ios_base::fmtflags(0),
+        ard::ios_base::floatfield
+    };
+
+    std::atomic<unsigned long long> failures(0);
+    std::mutex print_lock;
+
+    // Reports the first few mismatches only
+    void fail(float f, ard::ios_base::fmtflags fmt, int prec,
+              const std::string& a, const std::string& b)
+    {
+        if (++failures > 20)
+            return;
+        std::lock_guard<std::mutex> lock(print_lock);
+        printf("%a flags=%#x precision=%d: float '%s', double '%s'\n",
+               f, unsigned(fmt), prec, a.c_str(), b.c_str());
+    }
+
+    void check(uint64_t first, uint64_t last, uint64_t stride)
+    {
+        ard::ostringstream a, b;
+        for (uint64_t i = first; i < last; i += stride) {
+            const uint32_t bits = uint32_t(i);
+            float f;
+            memcpy(&f, &bits, sizeof(f));
+
+            // Precision 0 to 9 by pattern, fixed notation of large
+            // values only up to 2 to keep the run short
+            for (ard::ios_base::fmtflags fmt : formats) {
+                int prec = int((i / stride) % 10);
+                if (fmt == ard::ios_base::fixed && std::fabs(f) > 1e12f)
+                    prec %= 3;
+
+                a.str("");
+                b.str("");
+                a.flags(fmt);
+                b.flags(fmt);
+                a.precision(prec);
+                b.precision(prec);
+                a << f;
+                b << double(f);
+                if (a.view() != b.view())
+                    fail(f, fmt, prec, a.str(), b.str());
+            }
+        }
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const uint64_t stride = argc > 1 ? strtoull(argv[1], nullptr, 0) : 1009;
+    const uint64_t first = argc > 2 ? strtoull(argv[2], nullptr, 0) : 0;
+    const uint64_t last = argc > 3 ? strtoull(argv[3], nullptr, 0) : 1ull << 32;
+    if (!stride || first >= last) {
+        fprintf(stderr, "usage: %s [stride [first [last]]]\n", argv[0]);
+        return 2;
+    }
+
+    // Each thread takes a slice of whole strides
+    const unsigned nt = std::max(1u, std::thread::hardware_concurrency());
+    const uint64_t steps = (last - first + stride - 1) / stride;
+    const uint64_t per = (steps + nt - 1) / nt;
+    std::vector<std::thread> threads;
+    for (unsigned t = 0; t < nt; ++t) {
+        const uint64_t b = first + t * per * stride;
+        const uint64_t e = std::min(last, b + per * stride);
+        if (b < e)
+            threads.emplace_back(check, b, e, stride);
+    }
+    for (std::thread& t : threads)
+        t.join();
+
+    printf("%llu mismatches in %llu floats\n", failures.load(), (unsigned long long)steps);
+    return failures ? 1 : 0;
+}
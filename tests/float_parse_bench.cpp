@@ -0,0 +1,173 @@
+// Copyright (C) 2019 Vladimir Talybin.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+// Throughput of float extraction, operator>> against the way num_get
+// worked before: the characters collected into a std::string with
+// reserve(32) and converted with strtof/strtod/strtold. Heap
+// allocations per value are counted too.
+//
+//   float_parse_bench [values]
+
+#include "arduino.h"
+#include <sstream.hpp>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <random>
+
+namespace
+{
+    unsigned long long allocations = 0;
+}
+
+void* operator new(size_t n)
+{
+    ++allocations;
+    if (void* p = malloc(n ? n : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept
+{ free(p); }
+
+void operator delete(void* p, size_t) noexcept
+{ free(p); }
+
+namespace
+{
+    double strto_(const char* s, double*)
+    { return strtod(s, nullptr); }
+
+    float strto_(const char* s, float*)
+    { return strtof(s, nullptr); }
+
+    long double strto_(const char* s, long double*)
+    { return strtold(s, nullptr); }
+
+    // The previous num_get: sign, digits, point and exponent copied
+    // into a string for strtod
+    template <class ValueT>
+    void strtod_extract(ard::istream& in, ValueT& v)
+    {
+        ard::istream::sentry cerb(in);
+        if (!cerb)
+            return;
+
+        ard::basic_streambuf<char>* sb = in.rdbuf();
+        std::string xtrc;
+        xtrc.reserve(32);
+
+        int c = sb->sgetc();
+        if (c == '+' || c == '-') {
+            xtrc += char(c);
+            c = sb->snextc();
+        }
+        bool found_dec = false;
+        bool found_sci = false;
+        bool found_mantissa = false;
+        for (; c != EOF; c = sb->snextc()) {
+            if (c >= '0' && c <= '9') {
+                xtrc += char(c);
+                found_mantissa = true;
+            }
+            else if (c == '.' && !found_dec && !found_sci) {
+                xtrc += '.';
+                found_dec = true;
+            }
+            else if ((c == 'e' || c == 'E') && !found_sci && found_mantissa) {
+                xtrc += 'e';
+                found_sci = true;
+                c = sb->snextc();
+                if (c == '+' || c == '-')
+                    xtrc += char(c);
+                else if (c == EOF)
+                    break;
+                else
+                    sb->sungetc();
+            }
+            else
+                break;
+        }
+        v = strto_(xtrc.c_str(), static_cast<ValueT*>(nullptr));
+        if (c == EOF)
+            in.setstate(ard::ios_base::eofbit);
+    }
+
+    template <class ValueT, class Extract>
+    void run(const char* name, const std::string& text, size_t count, Extract extract)
+    {
+        double best = 1e30;
+        unsigned long long allocs = 0;
+        ValueT sum = 0;
+        for (int r = 0; r < 5; ++r) {
+            ard::istringstream in(text);
+            sum = 0;
+            const unsigned long long a0 = allocations;
+            const auto t0 = std::chrono::steady_clock::now();
+            ValueT v = ValueT();
+            for (size_t i = 0; i < count && (extract(in, v), in); ++i)
+                sum += v;
+            const auto t1 = std::chrono::steady_clock::now();
+            allocs = allocations - a0;
+            best = std::min(best, std::chrono::duration<double, std::nano>(t1 - t0).count());
+        }
+        printf("  %-10s %8.1f ns/value %6.2f allocations/value (sum %Lg)\n",
+               name, best / count, double(allocs) / count, (long double)sum);
+    }
+
+    template <class ValueT>
+    void bench(const char* title, const std::string& text, size_t count)
+    {
+        printf("%s\n", title);
+        run<ValueT>("operator>>", text, count,
+            [](ard::istream& in, ValueT& v) { in >> v; });
+        run<ValueT>("strtod", text, count,
+            [](ard::istream& in, ValueT& v) { strtod_extract(in, v); });
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const size_t count = argc > 1 ? strtoul(argv[1], nullptr, 0) : 200000;
+    std::mt19937_64 rng(2019);
+    char buf[64];
+
+    // Sensor readings, few digits
+    std::string telemetry;
+    std::uniform_int_distribution<int> reading(-5000, 50000);
+    for (size_t i = 0; i < count; ++i) {
+        snprintf(buf, sizeof(buf), "%.2f ", reading(rng) / 100.0);
+        telemetry += buf;
+    }
+
+    // Round trip precision over the whole range
+    std::string doubles, floats;
+    std::uniform_real_distribution<double> frac(-1.0, 1.0);
+    std::uniform_int_distribution<int> exp10(-300, 300), exp10f(-35, 35);
+    for (size_t i = 0; i < count; ++i) {
+        const double m = frac(rng);
+        snprintf(buf, sizeof(buf), "%.17g ", m * std::pow(10.0, exp10(rng)));
+        doubles += buf;
+        snprintf(buf, sizeof(buf), "%.9g ", float(m * std::pow(10.0, exp10f(rng))));
+        floats += buf;
+    }
+
+    bench<double>("double, telemetry (\"%.2f\")", telemetry, count);
+    bench<double>("double, 17 digits", doubles, count);
+    bench<float>("float, 9 digits", floats, count);
+    bench<long double>("long double, 17 digits", doubles, count);
+}
@@ -0,0 +1,227 @@
+// Copyright (C) 2019 Vladimir Talybin.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+// Checks float, double and long double extraction against strtof,
+// strtod and strtold. Most cases are the exact decimal expansion of
+// a halfway point between two adjacent values, which has up to 767
+// significant digits for double, and digit strings just above and
+// just below it. The rest are random short numbers.
+
+#include "arduino.h"
+#include <sstream.hpp>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include <random>
+#include <vector>
+
+namespace
+{
+    int failures = 0;
+    int total = 0;
+
+    // Unsigned integer in decimal, limbs of 10^9 least significant
+    // first, enough to write out halfway points exactly
+    struct decimal
+    {
+        std::vector<uint32_t> limbs;
+
+        explicit decimal(unsigned long long v)
+        {
+            for (; v; v /= 1000000000)
+                limbs.push_back(uint32_t(v % 1000000000));
+        }
+
+        // *this = *this * m + a, m * 10^9 fits 64 bits
+        void mul_add(uint32_t m, uint32_t a = 0)
+        {
+            uint64_t carry = a;
+            for (uint32_t& l : limbs) {
+                const uint64_t p = uint64_t(l) * m + carry;
+                l = uint32_t(p % 1000000000);
+                carry = p / 1000000000;
+            }
+            for (; carry; carry /= 1000000000)
+                limbs.push_back(uint32_t(carry % 1000000000));
+        }
+
+        void mul_pow(uint32_t b, int n)
+        {
+            // b^k below 2^32 at a time
+            uint32_t chunk = 1;
+            int k = 0;
+            while (uint64_t(chunk) * b < (1ull << 32)) {
+                chunk *= b;
+                ++k;
+            }
+            for (; n >= k; n -= k)
+                mul_add(chunk);
+            for (; n > 0; --n)
+                mul_add(b);
+        }
+
+        std::string str() const
+        {
+            if (limbs.empty())
+                return "0";
+            std::string s = std::to_string(limbs.back());
+            char buf[16];
+            for (size_t i = limbs.size() - 1; i-- > 0; ) {
+                snprintf(buf, sizeof(buf), "%09u", unsigned(limbs[i]));
+                s += buf;
+            }
+            return s;
+        }
+    };
+
+    long double ref_strto(const char* s, float*)
+    { return strtof(s, nullptr); }
+
+    long double ref_strto(const char* s, double*)
+    { return strtod(s, nullptr); }
+
+    long double ref_strto(const char* s, long double*)
+    { return strtold(s, nullptr); }
+
+    template <class ValueT>
+    void check(const std::string& s, const char* what)
+    {
+        using limits = std::numeric_limits<ValueT>;
+
+        const ValueT expect = ValueT(ref_strto(s.c_str(), static_cast<ValueT*>(nullptr)));
+
+        ard::istringstream in(s);
+        ValueT v = 0;
+        in >> v;
+
+        // Out of range sets failbit with the largest value
+        bool ok;
+        if (std::isinf(expect))
+            ok = in.fail() && v == (expect < 0 ? -limits::max() : limits::max());
+        else
+            ok = !in.fail() && v == expect && std::signbit(v) == std::signbit(expect);
+
+        ++total;
+        if (!ok && ++failures <= 20) {
+            printf("%s (%d digits, %s): got %La, expected %La\n",
+                   s.size() > 60 ? (s.substr(0, 28) + "..." + s.substr(s.size() - 28)).c_str() : s.c_str(),
+                   int(s.size()), what, (long double)v, (long double)expect);
+        }
+    }
+
+    // The halfway point above m * 2^e, with m < 2^64, as digits d
+    // times 10^-k
+    void halfway(unsigned long long m, int e, std::string& d, int& k)
+    {
+        decimal h(m);
+        h.mul_add(2, 1);
+        if (e - 1 >= 0) {
+            h.mul_pow(2, e - 1);
+            k = 0;
+        }
+        else {
+            // (2m + 1) * 2^(e - 1) = (2m + 1) * 5^(1 - e) / 10^(1 - e)
+            h.mul_pow(5, 1 - e);
+            k = 1 - e;
+        }
+        d = h.str();
+    }
+
+    std::string sci(const std::string& d, int k)
+    { return d + "e-" + std::to_string(k); }
+
+    // Tie, just above and just below the halfway point above x, the
+    // last two with digits past what is kept
+    template <class ValueT>
+    void check_halfway(ValueT x)
+    {
+        using limits = std::numeric_limits<ValueT>;
+
+        // x = m * 2^e with e the exponent of the unit in the last place
+        int ex = 0;
+        std::frexp(x, &ex);
+        const int e = (x == 0 || ex < limits::min_exponent ? limits::min_exponent : ex) - limits::digits;
+        const unsigned long long m = (unsigned long long)std::ldexp(x, -e);
+
+        std::string d;
+        int k;
+        halfway(m, e, d, k);
+        const std::string pad(ard::halfway_digits<ValueT>::value + 8, '0');
+
+        check<ValueT>(sci(d, k), "tie");
+        check<ValueT>(sci(d + "1", k + 1), "above");
+        check<ValueT>(sci(d + pad + "1", k + int(pad.size()) + 1), "above, long");
+
+        // One less in the last digit, then nines
+        std::string below = d;
+        size_t i = below.size() - 1;
+        for (; below[i] == '0'; --i)
+            below[i] = '9';
+        --below[i];
+        check<ValueT>(sci(below + pad + "9", k + int(pad.size()) + 1), "below, long");
+        check<ValueT>(sci(below + "9", k + 1), "below");
+    }
+
+    template <class ValueT>
+    void check_type(std::mt19937_64& rng)
+    {
+        using limits = std::numeric_limits<ValueT>;
+
+        // Subnormals and the first normals
+        const ValueT tiny = limits::denorm_min();
+        for (int i = 0; i < 8; ++i)
+            check_halfway<ValueT>(tiny * i);
+        check_halfway<ValueT>(limits::min() - tiny);
+        check_halfway<ValueT>(limits::min());
+        check_halfway<ValueT>(limits::min() + tiny);
+        check_halfway<ValueT>(limits::min() + 2 * tiny);
+
+        // Random normals of all exponents, and the largest ones. The
+        // halfway point above max() rounds up to infinity.
+        std::uniform_real_distribution<double> frac(0.5, 1.0);
+        for (int i = 0; i < 200; ++i) {
+            const int e = limits::min_exponent +
+                int(rng() % (limits::max_exponent - limits::min_exponent));
+            check_halfway<ValueT>(std::ldexp(ValueT(frac(rng)), e));
+        }
+        check_halfway<ValueT>(std::nextafter(limits::max(), ValueT(0)));
+        check_halfway<ValueT>(limits::max());
+
+        // Random short numbers
+        char buf[64];
+        for (int i = 0; i < 20000; ++i) {
+            const int nd = 1 + int(rng() % 20);
+            std::string s = rng() % 2 ? "-" : "";
+            for (int j = 0; j < nd; ++j)
+                s += char('0' + rng() % 10);
+            const int e = int(rng() % (2 * limits::max_exponent10 + 40)) - limits::max_exponent10 - 20;
+            snprintf(buf, sizeof(buf), "e%d", e - nd / 2);
+            s.insert(s.size() - nd / 2, ".");
+            check<ValueT>(s + buf, "random");
+        }
+    }
+}
+
+int main()
+{
+    std::mt19937_64 rng(2019);
+    check_type<float>(rng);
+    check_type<double>(rng);
+    check_type<long double>(rng);
+
+    printf("%d of %d values differ\n", failures, total);
+    return failures ? 1 : 0;
+}
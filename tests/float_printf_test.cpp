@@ -0,0 +1,173 @@
+// Copyright (C) 2019 Vladimir Talybin.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+// Checks that double and long double are formatted as the same
+// characters as snprintf writes for %f, %e, %g and %a, with the
+// flags and precision mapped to the conversion, for special values
+// and pseudo-random bit patterns.
+
+#include "arduino.h"
+#include <sstream.hpp>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+namespace
+{
+    const ard::ios_base::fmtflags formats[] = {
+        ard::ios_base::fixed,
+        ard::ios_base::scientific,
+        ard::ios_base::fmtflags(0),
+        ard::ios_base::floatfield
+    };
+
+    const ard::ios_base::fmtflags modifiers[] = {
+        ard::ios_base::fmtflags(0),
+        ard::ios_base::showpos,
+        ard::ios_base::showpoint,
+        ard::ios_base::uppercase
+    };
+
+    unsigned long long failures = 0;
+    unsigned long long checked = 0;
+
+    uint64_t lcg_ = 0x853c49e6748fea9bull;
+
+    uint64_t random64()
+    {
+        lcg_ = lcg_ * 6364136223846793005ull + 1442695040888963407ull;
+        return lcg_ ^ (lcg_ >> 29);
+    }
+
+    template <class T> const char* length_mod();
+    template <> const char* length_mod<double>() { return ""; }
+    template <> const char* length_mod<long double>() { return "L"; }
+
+    // The printf conversion the stream flags stand for
+    template <class T>
+    std::string printf_format(ard::ios_base::fmtflags f, int prec, T v)
+    {
+        const bool upper = f & ard::ios_base::uppercase;
+        char conv;
+        switch (f & ard::ios_base::floatfield) {
+        // Fixed is %f as in libstdc++, never uppercase
+        case ard::ios_base::fixed: conv = 'f'; break;
+        case ard::ios_base::scientific: conv = upper ? 'E' : 'e'; break;
+        case ard::ios_base::floatfield: conv = upper ? 'A' : 'a'; break;
+        default: conv = upper ? 'G' : 'g'; break;
+        }
+
+        char fmt[16];
+        snprintf(fmt, sizeof(fmt), "%%%s%s%s%s%c",
+                 (f & ard::ios_base::showpos) ? "+" : "",
+                 (f & ard::ios_base::showpoint) ? "#" : "",
+                 conv == 'a' || conv == 'A' ? "" : ".*",
+                 length_mod<T>(), conv);
+
+        const int n = (conv == 'a' || conv == 'A') ?
+            snprintf(nullptr, 0, fmt, v) : snprintf(nullptr, 0, fmt, prec, v);
+        std::vector<char> buf(n + 1);
+        if (conv == 'a' || conv == 'A')
+            snprintf(buf.data(), buf.size(), fmt, v);
+        else
+            snprintf(buf.data(), buf.size(), fmt, prec, v);
+        return std::string(buf.data(), n);
+    }
+
+    template <class T>
+    void check(T v, int seq)
+    {
+        ard::ostringstream os;
+        for (ard::ios_base::fmtflags fmt : formats) {
+            // Fixed notation of large values only up to 2 to keep
+            // the run short
+            int prec = seq % 20;
+            if (fmt == ard::ios_base::fixed && std::fabs(v) > T(1e30))
+                prec %= 3;
+            const ard::ios_base::fmtflags f = fmt | modifiers[seq % 4];
+
+            os.str("");
+            os.flags(f);
+            os.precision(prec);
+            os << v;
+            const std::string want = printf_format(f, prec, v);
+            ++checked;
+            if (os.view() != ard::string_view(want.data(), want.size()) && ++failures <= 20) {
+                printf("%La flags=%#x precision=%d: '%s', printf '%s'\n",
+                       (long double)v, unsigned(f), prec, os.str().c_str(), want.c_str());
+            }
+        }
+    }
+
+    template <class T>
+    void specials()
+    {
+        using limits = std::numeric_limits<T>;
+        const T values[] = {
+            T(0), -T(0), T(1), T(-1), T(0.5), T(0.1), T(1) / T(3), T(2) / T(3),
+            T(9.5), T(0.05), T(123456789), T(1e22), T(1e23), T(5e-324),
+            limits::min(), limits::max(), limits::denorm_min(), limits::epsilon(),
+            limits::min() / 2, limits::infinity(), -limits::infinity(),
+            limits::quiet_NaN()
+        };
+        int seq = 0;
+        for (T v : values) {
+            for (int i = 0; i < 20; ++i)
+                check(v, seq++);
+        }
+    }
+
+    void random_doubles(int count)
+    {
+        for (int i = 0; i < count; ++i) {
+            const uint64_t bits = random64();
+            double d;
+            memcpy(&d, &bits, sizeof(d));
+            if (std::isfinite(d))
+                check(d, i);
+        }
+    }
+
+    // Full 64-bit mantissas over the whole exponent range,
+    // subnormals included
+    void random_long_doubles(int count)
+    {
+        using limits = std::numeric_limits<long double>;
+        const int emin = limits::min_exponent - limits::digits - 1;
+        const int span = limits::max_exponent - emin;
+        for (int i = 0; i < count; ++i) {
+            const uint64_t m = random64() | (1ull << 63);
+            const int e = emin + int(random64() % span);
+            long double v = std::ldexp((long double)m, e - 64);
+            if (i & 1)
+                v = -v;
+            if (std::isfinite(v))
+                check(v, i);
+        }
+    }
+}
+
+int main()
+{
+    specials<double>();
+    specials<long double>();
+    random_doubles(10000);
+    random_long_doubles(2000);
+
+    printf("%llu mismatches in %llu conversions\n", failures, checked);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,151 @@
+// Copyright (C) 2019 Vladimir Talybin.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+// incremental_extractor fed in parts: a value split across feeds,
+// the token length limit and feeding from a non-blocking stream.
+
+#include "arduino.h"
+#include <ard-streams.h>
+#include <cstdio>
+#include <cstring>
+
+namespace
+{
+    int failures = 0;
+
+    void expect(bool ok, const char* what)
+    {
+        if (!ok) {
+            ++failures;
+            printf("FAILED: %s\n", what);
+        }
+    }
+
+    template <class X>
+    const char* feed(X& x, const char* s)
+    { return x.feed(s, s + strlen(s)); }
+
+    void split()
+    {
+        ard::incremental_extractor<int> x;
+        const char* a = "  12";
+        expect(feed(x, a) == a + 4 && x.state() == ard::extract_state::pending,
+               "split: all of the first part is taken");
+        const char* b = "34 5";
+        expect(feed(x, b) == b + 2, "split: stops at the end of the value");
+        expect(x.state() == ard::extract_state::done && x.value() == 1234,
+               "split: value of both parts");
+        expect(feed(x, "9") != nullptr && x.value() == 1234, "split: done until reset()");
+
+        x.reset();
+        feed(x, "-");
+        expect(x.state() == ard::extract_state::pending, "split: sign alone is pending");
+        feed(x, "0x7");
+        expect(x.state() == ard::extract_state::done && x.value() == 0,
+               "split: decimal by default, stops at the x");
+
+        ard::incremental_extractor<double> d;
+        feed(d, "3.");
+        feed(d, "25e");
+        feed(d, "1;");
+        expect(d.state() == ard::extract_state::done && d.value() == 32.5,
+               "split: double across three feeds");
+
+        x.reset();
+        feed(x, "42");
+        expect(x.finish() == ard::extract_state::done && x.value() == 42,
+               "finish: value at the end of input");
+        x.reset();
+        expect(x.finish() == ard::extract_state::failed, "finish: nothing collected");
+
+        x.reset();
+        feed(x, "x");
+        expect(x.state() == ard::extract_state::failed, "failed: not a number");
+        x.reset();
+        feed(x, "99999999999 ");
+        expect(x.state() == ard::extract_state::failed &&
+               x.value() == std::numeric_limits<int>::max(), "failed: out of range for int");
+    }
+
+    void length_limit()
+    {
+        // 32 characters is the longest token
+        ard::incremental_extractor<long long> x;
+        const char* s32 = "00000000000000000000000000000001";
+        feed(x, s32);
+        expect(x.state() == ard::extract_state::pending, "limit: 32 characters pending");
+        feed(x, " ");
+        expect(x.state() == ard::extract_state::done && x.value() == 1,
+               "limit: 32 characters parsed");
+
+        x.reset();
+        const char* s33 = "000000000000000000000000000000001";
+        feed(x, s33);
+        expect(x.state() == ard::extract_state::failed, "limit: 33 characters fail");
+
+        // The same split over feeds
+        x.reset();
+        feed(x, "0000000000000000");
+        feed(x, "0000000000000000");
+        expect(x.state() == ard::extract_state::pending, "limit: 32 characters in two feeds");
+        feed(x, "1");
+        expect(x.state() == ard::extract_state::failed, "limit: 33rd character in a later feed");
+
+        ard::incremental_extractor<int, 4> small;
+        feed(small, "1234");
+        expect(feed(small, "\n") != nullptr && small.value() == 1234, "limit: own limit");
+        small.reset();
+        feed(small, "12345");
+        expect(small.state() == ard::extract_state::failed, "limit: beyond own limit");
+    }
+
+    void from_stream()
+    {
+        memory_serial ser;
+        char ibuf[8];
+        ard::iserialstream in(ser, ibuf, sizeof(ibuf));
+        in.blocking(false);
+
+        ard::incremental_extractor<int> x;
+        expect(x.feed(in) == ard::extract_state::pending, "stream: no data");
+        ser.feed(" -5");
+        expect(x.feed(in) == ard::extract_state::pending, "stream: part of the value");
+        ser.feed("6\nz");
+        expect(x.feed(in) == ard::extract_state::done && x.value() == -56,
+               "stream: value complete");
+        expect(in.get() == '\n' && in.get() == 'z', "stream: the end is left in the stream");
+
+        // Unbuffered, one character at a time
+        memory_serial raw;
+        ard::iserialstream rin(raw);
+        rin.blocking(false);
+        x.reset();
+        raw.feed("7");
+        expect(x.feed(rin) == ard::extract_state::pending, "unbuffered: part of the value");
+        raw.feed("8 ");
+        expect(x.feed(rin) == ard::extract_state::done && x.value() == 78,
+               "unbuffered: value complete");
+        expect(rin.get() == ' ', "unbuffered: the end is left in the stream");
+    }
+}
+
+int main()
+{
+    split();
+    length_limit();
+    from_stream();
+
+    return failures ? 1 : 0;
+}
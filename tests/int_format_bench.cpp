@@ -0,0 +1,201 @@
+// Copyright (C) 2019 Vladimir Talybin.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+// Cost of int_to_char per value for every unsigned integer width in
+// decimal, octal and hex, against the previous loop of one digit per
+// step. Values have random bit lengths. Core cycles are counted with
+// perf_event_open() on Linux. Where that is not permitted, the x86
+// time stamp counter is read instead, which counts reference cycles
+// at a fixed rate. Cycles on the MCU itself have to be measured
+// there, e.g. with the DWT cycle counter on Cortex-M.
+//
+//   int_format_bench [values]
+
+#include "arduino.h"
+#include <ostream.hpp>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define HAVE_TSC 1
+#endif
+
+namespace
+{
+    using ard::ios_base;
+
+    // int_to_char before digit pairs
+    template <class CharT, class ValueT>
+    int digit_loop(CharT* bufend, ValueT v, ios_base::fmtflags flags, bool dec)
+    {
+        CharT* buf = bufend;
+        if (dec) {
+            do {
+                *--buf = '0' + (v % 10);
+                v /= 10;
+            }
+            while (v != 0);
+        }
+        else if ((flags & ios_base::basefield) == ios_base::oct) {
+            do {
+                *--buf = '0' + (v & 0x7);
+                v >>= 3;
+            }
+            while (v != 0);
+        }
+        else {
+            const CharT alpha = "aA"[(flags & ios_base::uppercase) != 0];
+            do {
+                int nibble = v & 0xf;
+                *--buf = nibble + (nibble < 10 ? '0' : (alpha - 10));
+                v >>= 4;
+            }
+            while (v != 0);
+        }
+        return bufend - buf;
+    }
+
+    struct timing
+    {
+        double ns;
+        double cycles;
+    };
+
+    // Core cycle counter of this thread, -1 if not available
+    int cycle_counter = -1;
+
+    void open_cycle_counter()
+    {
+#ifdef __linux__
+        perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.size = sizeof(attr);
+        attr.config = PERF_COUNT_HW_CPU_CYCLES;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        cycle_counter = int(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+#endif
+    }
+
+    unsigned long long cycles()
+    {
+        unsigned long long n = 0;
+        if (cycle_counter >= 0 && read(cycle_counter, &n, sizeof(n)) == sizeof(n))
+            return n;
+#ifdef HAVE_TSC
+        return __rdtsc();
+#else
+        return 0;
+#endif
+    }
+
+    // Best of five, per value. The digits are summed so that the
+    // formatting is not optimized away.
+    template <class ValueT, class Format>
+    timing run(const std::vector<ValueT>& values, ios_base::fmtflags flags, Format format, unsigned& check)
+    {
+        const bool dec = (flags & ios_base::basefield) == ios_base::dec;
+        timing best = { 1e30, 1e30 };
+        for (int r = 0; r < 5; ++r) {
+            char buf[32];
+            unsigned sum = 0;
+            const auto t0 = std::chrono::steady_clock::now();
+            const unsigned long long c0 = cycles();
+            for (ValueT v : values) {
+                const int len = format(buf + sizeof(buf), v, flags, dec);
+                sum += len + buf[sizeof(buf) - len];
+            }
+            const unsigned long long c1 = cycles();
+            const auto t1 = std::chrono::steady_clock::now();
+            best.ns = std::min(best.ns, std::chrono::duration<double, std::nano>(t1 - t0).count());
+            best.cycles = std::min(best.cycles, double(c1 - c0));
+            check = sum;
+        }
+        best.ns /= values.size();
+        best.cycles /= values.size();
+        return best;
+    }
+
+    // Output of both must match on every value too
+    template <class ValueT>
+    bool same_output(const std::vector<ValueT>& values, ios_base::fmtflags flags)
+    {
+        const bool dec = (flags & ios_base::basefield) == ios_base::dec;
+        for (ValueT v : values) {
+            char a[32], b[32];
+            const int la = ard::int_to_char(a + sizeof(a), v, flags, dec);
+            const int lb = digit_loop(b + sizeof(b), v, flags, dec);
+            if (la != lb || memcmp(a + sizeof(a) - la, b + sizeof(b) - lb, la))
+                return false;
+        }
+        return true;
+    }
+
+    template <class ValueT>
+    void bench(const char* name, size_t count, std::mt19937_64& rng)
+    {
+        std::vector<ValueT> values(count);
+        for (ValueT& v : values)
+            v = ValueT(rng() >> (64 - 1 - rng() % (sizeof(ValueT) * 8)));
+
+        static const struct { const char* name; ios_base::fmtflags flags; } bases[] = {
+            { "dec", ios_base::dec },
+            { "oct", ios_base::oct },
+            { "hex", ios_base::hex },
+            { "HEX", ios_base::hex | ios_base::uppercase },
+        };
+        for (const auto& b : bases) {
+            unsigned c1, c2;
+            const timing pairs = run(values, b.flags,
+                [](char* e, ValueT v, ios_base::fmtflags f, bool d) { return ard::int_to_char(e, v, f, d); }, c1);
+            const timing loop = run(values, b.flags,
+                [](char* e, ValueT v, ios_base::fmtflags f, bool d) { return digit_loop(e, v, f, d); }, c2);
+            printf("%-20s %s %6.1f ns %6.1f cycles | digit loop %6.1f ns %6.1f cycles | %5.2fx%s\n",
+                   name, b.name, pairs.ns, pairs.cycles, loop.ns, loop.cycles, loop.ns / pairs.ns,
+                   c1 == c2 && same_output(values, b.flags) ? "" : " (output differs)");
+        }
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const size_t count = argc > 1 ? strtoul(argv[1], nullptr, 0) : 200000;
+    std::mt19937_64 rng(2019);
+
+    open_cycle_counter();
+    if (cycle_counter >= 0)
+        printf("Cycles are core cycles\n");
+    else {
+#ifdef HAVE_TSC
+        printf("No cycle counter, cycles are time stamp counter ticks\n");
+#else
+        printf("No cycle counter, cycles are not measured\n");
+#endif
+    }
+    bench<unsigned short>("unsigned short", count, rng);
+    bench<unsigned int>("unsigned int", count, rng);
+    bench<unsigned long>("unsigned long", count, rng);
+    bench<unsigned long long>("unsigned long long", count, rng);
+}
@@ -0,0 +1,104 @@
+// Copyright (C) 2019 Vladimir Talybin.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+// Throughput of numeric extraction from an istringstream, operator>>
+// parsing from the get area against num_get over istreambuf_iterator
+// as it was done before.
+//
+//   num_get_bench [values]
+
+#include "arduino.h"
+#include <sstream.hpp>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+
+namespace
+{
+    // The previous extraction, a character at a time through the
+    // stream buffer
+    template <class ValueT>
+    void iterator_extract(ard::istream& in, ValueT& v)
+    {
+        ard::istream::sentry cerb(in, false);
+        if (cerb) {
+            const ard::istream::num_get_type ng;
+            ard::ios_base::iostate err = ard::ios_base::goodbit;
+            ng.get(in, {}, in, err, v);
+            if (err)
+                in.setstate(err);
+        }
+    }
+
+    template <class ValueT, class Extract>
+    double run(const std::string& text, size_t count, Extract extract, ValueT& sum)
+    {
+        double best = 1e30;
+        for (int r = 0; r < 5; ++r) {
+            ard::istringstream in(text);
+            sum = 0;
+            const auto t0 = std::chrono::steady_clock::now();
+            ValueT v = ValueT();
+            for (size_t i = 0; i < count && (extract(in, v), in); ++i)
+                sum += v;
+            const auto t1 = std::chrono::steady_clock::now();
+            best = std::min(best, std::chrono::duration<double, std::nano>(t1 - t0).count());
+        }
+        return best / count;
+    }
+
+    template <class ValueT>
+    void bench(const char* title, const std::string& text, size_t count)
+    {
+        ValueT a, b;
+        const double fast = run<ValueT>(text, count,
+            [](ard::istream& in, ValueT& v) { in >> v; }, a);
+        const double slow = run<ValueT>(text, count,
+            [](ard::istream& in, ValueT& v) { iterator_extract(in, v); }, b);
+        printf("%-24s %8.1f ns/value get area %8.1f ns/value iterator %5.2fx%s\n",
+               title, fast, slow, slow / fast, a == b ? "" : " (results differ)");
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const size_t count = argc > 1 ? strtoul(argv[1], nullptr, 0) : 500000;
+    std::mt19937_64 rng(2019);
+    char buf[64];
+
+    // Integers of all lengths, and short and long decimals
+    std::string ints, longs, readings, doubles;
+    std::uniform_int_distribution<int> digits(1, 9), reading(-5000, 50000);
+    std::uniform_real_distribution<double> frac(-1.0, 1.0);
+    std::uniform_int_distribution<int> exp10(-30, 30);
+    for (size_t i = 0; i < count; ++i) {
+        snprintf(buf, sizeof(buf), "%d ", int(rng() % 2000000000) / int(std::pow(10, digits(rng) - 1)) - 1000);
+        ints += buf;
+        snprintf(buf, sizeof(buf), "%llu\n", (unsigned long long)(rng() >> (rng() % 64)));
+        longs += buf;
+        snprintf(buf, sizeof(buf), "%.2f ", reading(rng) / 100.0);
+        readings += buf;
+        snprintf(buf, sizeof(buf), "%.17g ", frac(rng) * std::pow(10.0, exp10(rng)));
+        doubles += buf;
+    }
+
+    bench<long>("long", ints, count);
+    bench<unsigned long long>("unsigned long long", longs, count);
+    bench<double>("double, \"%.2f\"", readings, count);
+    bench<double>("double, 17 digits", doubles, count);
+    bench<float>("float, \"%.2f\"", readings, count);
+}
@@ -0,0 +1,136 @@
+// Copyright (C) 2019 Vladimir Talybin.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+// Runs a producer thread writing into an oringstream against a
+// consumer thread draining it, with both overflow policies. What is
+// drained must be what was written with dropped() characters left
+// out, in order.
+
+#include "arduino.h"
+#include <ringbuf.hpp>
+#include <sstream.hpp>
+#include <atomic>
+#include <cstdio>
+#include <thread>
+
+namespace
+{
+    int failures = 0;
+
+    void expect(bool ok, const char* what)
+    {
+        if (!ok) {
+            ++failures;
+            printf("FAILED: %s\n", what);
+        }
+    }
+
+    // Device taking at most limit characters per write()
+    struct string_device
+    {
+        std::string out;
+        size_t limit = size_t(-1);
+
+        size_t write(const uint8_t* s, size_t n)
+        {
+            n = std::min(n, limit);
+            out.append(reinterpret_cast<const char*>(s), n);
+            return n;
+        }
+    };
+
+    // True if sub is what is left of s after taking characters out
+    bool is_subsequence(const std::string& sub, const std::string& s)
+    {
+        size_t j = 0;
+        for (size_t i = 0; i < s.size() && j < sub.size(); ++i)
+            j += s[i] == sub[j];
+        return j == sub.size();
+    }
+
+    // Sink is drained into with drain(), its content is out_of(sink)
+    template <class Sink, class Out>
+    void run(const char* name, ard::ring_overflow policy, Sink& sink, Out out_of)
+    {
+        ard::oringstream<64> ring(policy);
+        std::atomic<bool> done(false);
+        std::string written;
+        const int lines = 20000;
+
+        // Yields now and then, so that most lines get through even
+        // on a single core
+        std::thread producer([&] {
+            for (int i = 0; i < lines; ++i) {
+                ring << "line " << i << '\n';
+                if (i % 4 == 0)
+                    std::this_thread::yield();
+            }
+            done = true;
+        });
+
+        // Drain until the producer is done and the ring is empty
+        std::thread consumer([&] {
+            while (!done || ring.rdbuf()->size())
+                ring.drain(sink);
+        });
+
+        for (int i = 0; i < lines; ++i)
+            written += "line " + std::to_string(i) + '\n';
+        producer.join();
+        consumer.join();
+
+        const std::string out = out_of(sink);
+        printf("%s: %zu written, %zu drained, %zu dropped\n",
+               name, written.size(), out.size(), ring.dropped());
+        expect(out.size() + ring.dropped() == written.size(), "drained and dropped add up");
+        expect(is_subsequence(out, written), "drained in order");
+    }
+
+    // A device that takes part of each write keeps the rest in the
+    // ring with drop_newest, and drops it with drop_oldest
+    void short_writes()
+    {
+        for (ard::ring_overflow policy : { ard::ring_overflow::drop_newest,
+                                           ard::ring_overflow::drop_oldest })
+        {
+            ard::oringstream<64> ring(policy);
+            ring << "0123456789abcdefghij";
+            string_device dev;
+            dev.limit = 5;
+
+            expect(ring.drain(dev) == 5, "short write drains what was taken");
+            if (policy == ard::ring_overflow::drop_newest)
+                expect(ring.rdbuf()->size() == 15 && ring.dropped() == 0, "drop_newest keeps the rest");
+            else
+                expect(ring.rdbuf()->size() == 0 && ring.dropped() == 15, "drop_oldest counts the rest");
+        }
+    }
+}
+
+int main()
+{
+    string_device dev;
+    run("drop_newest to a device", ard::ring_overflow::drop_newest,
+        dev, [](string_device& d) { return d.out; });
+
+    ard::ostringstream os;
+    auto* sb = os.rdbuf();
+    run("drop_oldest to a stream buffer", ard::ring_overflow::drop_oldest,
+        sb, [](decltype(sb) b) { return b->str(); });
+
+    short_writes();
+
+    return failures ? 1 : 0;
+}
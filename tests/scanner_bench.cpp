@@ -0,0 +1,172 @@
+// Copyright (C) 2019 Vladimir Talybin.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+// Per token cost of the scanner against operator>>(std::string&) for
+// words and getline() for lines, from a string and from serial input
+// with a 64 byte buffer. Heap allocations per token are counted too.
+//
+//   scanner_bench [lines]
+
+#include "arduino.h"
+#include <ard-streams.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+    unsigned long long allocations = 0;
+}
+
+void* operator new(size_t n)
+{
+    ++allocations;
+    if (void* p = malloc(n ? n : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept
+{ free(p); }
+
+void operator delete(void* p, size_t) noexcept
+{ free(p); }
+
+namespace
+{
+    // Reads a string
+    struct text_serial : Stream
+    {
+        const std::string& text;
+        size_t pos = 0;
+
+        explicit text_serial(const std::string& s)
+        : text(s)
+        { }
+
+        size_t write(uint8_t) override
+        { return 0; }
+
+        int available() override
+        { return int(text.size() - pos); }
+
+        int read() override
+        { return pos < text.size() ? static_cast<unsigned char>(text[pos++]) : -1; }
+
+        int peek() override
+        { return pos < text.size() ? static_cast<unsigned char>(text[pos]) : -1; }
+    };
+
+    // Best of five, in ns and allocations per token. open() makes
+    // the stream and calls back with it, work() reads all tokens and
+    // returns a checksum, the same for each way of reading.
+    template <class Open, class Work>
+    void run(const char* name, size_t tokens, Open open, Work work)
+    {
+        double best = 1e30;
+        unsigned long long allocs = 0, check = 0;
+        for (int r = 0; r < 5; ++r) {
+            open([&](ard::istream& in) {
+                const unsigned long long a0 = allocations;
+                const auto t0 = std::chrono::steady_clock::now();
+                check = work(in);
+                const auto t1 = std::chrono::steady_clock::now();
+                allocs = allocations - a0;
+                best = std::min(best, std::chrono::duration<double, std::nano>(t1 - t0).count());
+            });
+        }
+        printf("  %-24s %7.2f ns/token %6.3f allocations/token (sum %llu)\n",
+               name, best / tokens, double(allocs) / tokens, check);
+    }
+
+    //
+    // Words and lines, returns the total of their lengths
+    //
+
+    unsigned long long extract_words(ard::istream& in)
+    {
+        unsigned long long sum = 0;
+        for (std::string s; in >> s; )
+            sum += s.size();
+        return sum;
+    }
+
+    unsigned long long getline_lines(ard::istream& in)
+    {
+        unsigned long long sum = 0;
+        for (std::string s; ard::getline(in, s); )
+            sum += s.size();
+        return sum;
+    }
+
+    unsigned long long scan_words(ard::istream& in)
+    {
+        ard::scanner sc(in);
+        unsigned long long sum = 0;
+        for (ard::string_view s; sc.next(s); )
+            sum += s.size();
+        return sum;
+    }
+
+    unsigned long long scan_lines(ard::istream& in)
+    {
+        ard::scanner sc(in);
+        unsigned long long sum = 0;
+        for (ard::string_view s; sc.line(s); )
+            sum += s.size();
+        return sum;
+    }
+
+    template <class Open>
+    void bench(const char* title, size_t words, size_t lines, Open open)
+    {
+        printf("%s\n", title);
+        run("operator>>(std::string&)", words, open, extract_words);
+        run("scanner next()", words, open, scan_words);
+        run("getline()", lines, open, getline_lines);
+        run("scanner line()", lines, open, scan_lines);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const size_t lines = argc > 1 ? strtoul(argv[1], nullptr, 0) : 100000;
+
+    // Sensor records, four words a line, one of them longer than
+    // std::string keeps inline
+    std::string text;
+    char buf[96];
+    for (size_t i = 0; i < lines; ++i) {
+        snprintf(buf, sizeof(buf), "T%zu %.2f %s %u\n", i % 8, (i * 7919 % 5000) / 100.0,
+                 i % 3 ? "ok" : "out_of_range_sensor_warning", unsigned(i * 31 % 1000));
+        text += buf;
+    }
+
+    bench("string", lines * 4, lines,
+        [&](auto timed) {
+            ard::istringstream in(text);
+            timed(in);
+        });
+    bench("serial 64", lines * 4, lines,
+        [&](auto timed) {
+            text_serial ser(text);
+            char ibuf[64];
+            ard::basic_serialbuf<char> sb(ser, ard::ios_base::in);
+            sb.setibuf(ibuf, sizeof(ibuf));
+            ard::istream in(&sb);
+            timed(in);
+        });
+}
@@ -0,0 +1,202 @@
+// Copyright (C) 2019 Vladimir Talybin.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+// Scanner words, fields and lines compared with a plain split, read
+// from a string and from serial input that is unbuffered or refilled
+// in the middle of tokens, and parse() at the ends of the value range.
+
+#include "arduino.h"
+#include <ard-streams.h>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace
+{
+    int failures = 0;
+
+    void expect(bool ok, const char* what)
+    {
+        if (!ok) {
+            ++failures;
+            printf("FAILED: %s\n", what);
+        }
+    }
+
+    const std::string text =
+        "alpha  beta\tgamma\n\nlonger_than_any_buffer x\n  12 -7 ;;end;";
+
+    // Words split at whitespace
+    std::vector<std::string> ref_words()
+    {
+        std::vector<std::string> v;
+        std::string w;
+        for (char c : text + ' ') {
+            if (ard::is_wsp(c)) {
+                if (!w.empty())
+                    v.push_back(w);
+                w.clear();
+            }
+            else
+                w += c;
+        }
+        return v;
+    }
+
+    // Fields up to each delim, the last one without it
+    std::vector<std::string> ref_fields(char delim)
+    {
+        std::vector<std::string> v;
+        size_t p = 0;
+        while (p < text.size()) {
+            const size_t end = std::min(text.find(delim, p), text.size());
+            v.push_back(text.substr(p, end - p));
+            p = end + 1;
+        }
+        return v;
+    }
+
+    template <class Next>
+    std::vector<std::string> scan(ard::scanner& sc, Next next)
+    {
+        std::vector<std::string> v;
+        ard::string_view tok;
+        while (next(sc, tok))
+            v.push_back(tok.to_string());
+        return v;
+    }
+
+    // Every buffer size from unbuffered to larger than a token, the
+    // buffer refilled in the middle of the longer ones
+    void serial()
+    {
+        char ibuf[9];
+        for (size_t bsize = 0; bsize <= sizeof(ibuf); ++bsize) {
+            for (int kind = 0; kind < 3; ++kind) {
+                memory_serial ser;
+                ser.feed(text);
+                ard::iserialstream in(ser);
+                in.rdbuf()->pubsetbuf(bsize ? ibuf : nullptr, bsize);
+                ard::scanner sc(in);
+
+                if (kind == 0) {
+                    expect(scan(sc, [](ard::scanner& s, ard::string_view& t)
+                                    { return s.next(t); }) == ref_words(),
+                           bsize ? "serial words" : "unbuffered words");
+                }
+                else if (kind == 1) {
+                    expect(scan(sc, [](ard::scanner& s, ard::string_view& t)
+                                    { return s.next(t, ';'); }) == ref_fields(';'),
+                           bsize ? "serial fields" : "unbuffered fields");
+                }
+                else {
+                    expect(scan(sc, [](ard::scanner& s, ard::string_view& t)
+                                    { return s.line(t); }) == ref_fields('\n'),
+                           bsize ? "serial lines" : "unbuffered lines");
+                }
+                expect(sc.eof() && ser.in.empty(), "serial input read to the end");
+            }
+        }
+    }
+
+    // Tokens within the get area are views into it
+    void string()
+    {
+        ard::istringstream in(text);
+        ard::scanner sc(in);
+        const char* beg = in.rdbuf()->gptr();
+        const char* end = in.rdbuf()->egptr();
+
+        ard::string_view tok;
+        size_t copied = 0;
+        std::vector<std::string> v;
+        while (sc.next(tok)) {
+            copied += tok.data() < beg || tok.data() + tok.size() > end;
+            v.push_back(tok.to_string());
+        }
+        expect(v == ref_words(), "string words");
+        // Only the last word, which ends the input, is copied
+        expect(copied == 1, "string words in place");
+
+        ard::istringstream lines("one\ntwo\n");
+        ard::scanner ls(lines);
+        expect(ls.line(tok) && tok.to_string() == "one" &&
+               tok.data() == lines.rdbuf()->eback(), "string line in place");
+        expect(ls.line(tok) && tok.to_string() == "two", "string last line");
+        expect(!ls.line(tok) && ls.eof(), "string no more lines");
+
+        // Whitespace after a word is left for the next read
+        ard::istringstream mixed("key value\n");
+        ard::scanner ms(mixed);
+        expect(ms.next(tok) && tok.to_string() == "key", "mixed word");
+        expect(ms.line(tok) && tok.to_string() == " value", "mixed rest of line");
+    }
+
+    template <class ValueT>
+    bool parses(const char* s, ValueT v, ard::ios_base::fmtflags base = ard::ios_base::dec)
+    {
+        ard::istringstream in;
+        ard::scanner sc(in);
+        sc.setf(base, ard::ios_base::basefield);
+        ValueT r = ValueT();
+        return sc.parse(ard::string_view(s), r) && r == v;
+    }
+
+    template <class ValueT>
+    bool rejects(const char* s)
+    {
+        ard::istringstream in;
+        ard::scanner sc(in);
+        ValueT r = ValueT();
+        return !sc.parse(ard::string_view(s), r);
+    }
+
+    void parse()
+    {
+        expect(parses<short>("32767", 32767) && parses<short>("-32768", -32768),
+               "parse short limits");
+        expect(rejects<short>("32768") && rejects<short>("-32769"), "parse short range");
+        expect(parses<int>("2147483647", 2147483647) &&
+               parses<int>("-2147483648", -2147483647 - 1), "parse int limits");
+        expect(rejects<int>("2147483648") && rejects<int>("-2147483649"), "parse int range");
+        expect(parses<long long>("9223372036854775807", 9223372036854775807LL),
+               "parse long long limit");
+        expect(rejects<long long>("9223372036854775808"), "parse long long range");
+        expect(parses<unsigned>("4294967295", 4294967295u), "parse unsigned limit");
+        expect(rejects<unsigned>("4294967296"), "parse unsigned range");
+
+        // All of the view or nothing
+        expect(rejects<int>("12x") && rejects<int>("") && rejects<int>("+"),
+               "parse partial value");
+        expect(parses<double>("21.5", 21.5) && rejects<double>("21.5.1"), "parse double");
+        expect(parses<int>("ff", 255, ard::ios_base::hex), "parse hex");
+
+        // The flags of the stream are taken over
+        ard::istringstream in;
+        in >> ard::hex;
+        ard::scanner sc(in);
+        int v = 0;
+        expect(sc.parse(ard::string_view("1f"), v) && v == 31, "parse stream flags");
+    }
+}
+
+int main()
+{
+    serial();
+    string();
+    parse();
+
+    return failures ? 1 : 0;
+}
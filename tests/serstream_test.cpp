@@ -0,0 +1,210 @@
+// Copyright (C) 2019 Vladimir Talybin.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+// Serial streams over memory_serial: when buffered output reaches the
+// device under each flush policy, read-ahead input with putback
+// across buffer refills, and non-blocking input, also through the
+// static serial buffer.
+
+#include "arduino.h"
+#include <ard-streams.h>
+#include <cstdio>
+
+namespace
+{
+    int failures = 0;
+
+    void expect(bool ok, const char* what)
+    {
+        if (!ok) {
+            ++failures;
+            printf("FAILED: %s\n", what);
+        }
+    }
+
+    void full_flush()
+    {
+        memory_serial ser;
+        char obuf[8];
+        {
+            ard::oserialstream out(ser, obuf, sizeof(obuf));
+            out << "abc";
+            expect(ser.out.empty(), "full: output is held in the buffer");
+            out << "defgh";
+            expect(ser.out.empty(), "full: a buffer just filled is not written yet");
+            out << 'i';
+            expect(ser.out == "abcdefgh", "full: written when a character does not fit");
+            out << '\n';
+            expect(ser.out == "abcdefgh", "full: newline does not drain");
+            out.flush();
+            expect(ser.out == "abcdefghi\n", "full: flush() drains");
+
+            // Larger than the buffer, straight to the device in order
+            out << "xy" << "0123456789";
+            expect(ser.out == "abcdefghi\nxy0123456789", "full: long write after pending output");
+            out << "end";
+        }
+        expect(ser.out == "abcdefghi\nxy0123456789end", "full: drained on destruction");
+    }
+
+    void line_flush()
+    {
+        memory_serial ser;
+        char obuf[8];
+        ard::oserialstream out(ser, obuf, sizeof(obuf), ard::serial_flush::line);
+        out << "ab";
+        expect(ser.out.empty(), "line: held until newline");
+        out << '\n';
+        expect(ser.out == "ab\n", "line: newline drains");
+        out << "cd\nef";
+        expect(ser.out == "ab\ncd\nef", "line: a write containing newline drains all of it");
+        out << 12 << ' ';
+        expect(ser.out == "ab\ncd\nef", "line: numbers are held too");
+        out << ard::endl;
+        expect(ser.out == "ab\ncd\nef12 \n", "line: endl drains");
+        out << "0123456789abc";
+        expect(ser.out == "ab\ncd\nef12 \n0123456789abc", "line: larger than the buffer");
+    }
+
+    void read_ahead()
+    {
+        memory_serial ser;
+        ser.feed("abcdefghij");
+        char ibuf[4];
+        ard::iserialstream in(ser, ibuf, sizeof(ibuf));
+
+        expect(in.get() == 'a', "read-ahead: first character");
+        expect(ser.in.size() == 6, "read-ahead: a buffer full is taken at once");
+        in.get();
+        in.get();
+        expect(in.get() == 'd', "read-ahead: last buffered character");
+
+        // The refill keeps 'd' in front for putback
+        expect(in.get() == 'e', "read-ahead: refilled");
+        expect(bool(in.unget()) && bool(in.unget()), "putback: across the refill");
+        expect(in.get() == 'd' && in.get() == 'e', "putback: same characters again");
+        in.putback('X');
+        expect(in.get() == 'X', "putback: a different character");
+        in.unget();
+        in.unget();
+        expect(!in.unget() && in.bad(), "putback: only one character before the refill");
+        in.clear();
+
+        // Numbers that span a refill are parsed across it
+        memory_serial num;
+        num.feed("12345 678 9");
+        ard::iserialstream nin(num, ibuf, sizeof(ibuf));
+        int a = 0, b = 0, c = 0;
+        nin >> a >> b >> c;
+        expect(a == 12345 && b == 678 && c == 9 && nin.eof() && !nin.fail(),
+               "read-ahead: numbers across refills");
+    }
+
+    void non_blocking()
+    {
+        memory_serial ser;
+        char ibuf[16];
+        ard::iserialstream in(ser, ibuf, sizeof(ibuf));
+        in.blocking(false);
+        int x = 0;
+
+        ser.feed("12");
+        in >> x;
+        expect(x == 12 && in.eof() && !in.fail() && in.would_block(),
+               "non-blocking: value up to the end of the data");
+        in.clear();
+
+        in >> x;
+        expect(in.fail() && in.would_block(), "non-blocking: no data yet");
+        in.clear();
+
+        ser.feed(" 34 ");
+        in >> x;
+        expect(x == 34 && in.good() && !in.would_block(), "non-blocking: more data");
+
+        // A short read takes what there is
+        ser.feed("xy");
+        char buf[4];
+        in.read(buf, 4);
+        expect(in.gcount() == 3 && in.eof() && in.would_block(), "non-blocking: short read()");
+        in.clear();
+
+        // Only the device sets and clears it. A read served from the
+        // input buffer leaves it as the last device access left it.
+        ser.feed("ab");
+        expect(in.rdbuf()->sgetfill(8) == 2 && in.would_block(), "non-blocking: fill ran out");
+        expect(in.get() == 'a' && in.would_block(), "non-blocking: buffered read keeps it set");
+        expect(in.get() == 'b' && in.would_block(), "non-blocking: still set");
+        ser.feed("c");
+        expect(in.get() == 'c' && !in.would_block(), "non-blocking: cleared by the next device read");
+
+        // Unbuffered
+        memory_serial raw;
+        ard::iserialstream rin(raw);
+        rin.blocking(false);
+        expect(rin.get() == EOF && rin.would_block(), "non-blocking unbuffered: no data");
+        rin.clear();
+        raw.feed("z");
+        expect(rin.get() == 'z' && !rin.would_block(), "non-blocking unbuffered: data");
+    }
+
+    // The static buffers share the device code
+    void static_buffers()
+    {
+        memory_serial ser;
+        {
+            ard::static_serialbuf<8> sb(ser, ard::serial_flush::line);
+            ard::static_ostream<ard::static_serialbuf<8>> out(sb);
+            out << "ab";
+            expect(ser.out.empty(), "static: held until newline");
+            out << 12 << '\n';
+            expect(ser.out == "ab12\n", "static: newline drains");
+            out << "0123456789";
+            expect(ser.out == "ab12\n0123456789", "static: larger than the buffer");
+            out << "end";
+        }
+        expect(ser.out == "ab12\n0123456789end", "static: drained on destruction");
+
+        memory_serial in_ser;
+        ard::static_serialbuf<0, 4> isb(in_ser);
+        ard::static_istream<ard::static_serialbuf<0, 4>> in(isb);
+        isb.blocking(false);
+        int x = 0;
+        in_ser.feed("12");
+        in >> x;
+        expect(x == 12 && in.eof() && !in.fail() && isb.would_block(),
+               "static non-blocking: value up to the end of the data");
+        in.clear();
+        in >> x;
+        expect(in.fail() && isb.would_block(), "static non-blocking: no data yet");
+        in.clear();
+        in_ser.feed(" 345 6");
+        in >> x;
+        expect(x == 345 && !in.fail(), "static non-blocking: across a refill");
+        in >> x;
+        expect(x == 6 && isb.would_block(), "static non-blocking: last value");
+    }
+}
+
+int main()
+{
+    full_flush();
+    line_flush();
+    read_ahead();
+    non_blocking();
+    static_buffers();
+
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,134 @@
+// Copyright (C) 2019 Vladimir Talybin.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+// Small string buffers: content in the inline storage, spilling to
+// the heap and returning to inline storage, and input only buffers.
+
+#include "arduino.h"
+#include <ard-streams.h>
+#include <cstdio>
+#include <cstring>
+
+namespace
+{
+    int failures = 0;
+
+    void expect(bool ok, const char* what)
+    {
+        if (!ok) {
+            ++failures;
+            printf("FAILED: %s\n", what);
+        }
+    }
+
+    void spill()
+    {
+        ard::small_ostringstream<12> os;
+        os << "id=" << 42;
+        expect(os.rdbuf()->is_inline() && os.view() == "id=42", "spill: short content inline");
+
+        os << " value=" << 1.5;
+        expect(!os.rdbuf()->is_inline(), "spill: moved to the heap");
+        expect(os.view() == "id=42 value=1.5" && os.str() == "id=42 value=1.5",
+               "spill: content kept");
+        os << '!';
+        expect(os.view() == "id=42 value=1.5!", "spill: appends on the heap");
+
+        // Moving out returns to the inline storage
+        std::string s = std::move(os).str();
+        expect(s == "id=42 value=1.5!", "move out: whole content");
+        expect(os.rdbuf()->is_inline() && os.view().empty(), "move out: inline and empty");
+        os << "next";
+        expect(os.rdbuf()->is_inline() && os.view() == "next", "move out: writes inline again");
+
+        // Moved out while inline
+        s = std::move(os).str();
+        expect(s == "next" && os.view().empty() && os.rdbuf()->is_inline(),
+               "move out: from the inline storage");
+    }
+
+    void set_str()
+    {
+        ard::small_ostringstream<8> os;
+        os.str("abc");
+        expect(os.rdbuf()->is_inline() && os.view() == "abc", "str(s): short string inline");
+        os << 'Z';
+        expect(os.view() == "Zbc", "str(s): output from the start");
+
+        os.str("12345678");
+        expect(os.rdbuf()->is_inline() && os.view() == "12345678", "str(s): exactly N inline");
+        os.str("123456789");
+        expect(!os.rdbuf()->is_inline() && os.view() == "123456789", "str(s): longer on the heap");
+        os.str(std::string("xy"));
+        expect(os.rdbuf()->is_inline() && os.view() == "xy", "str(s): back from the heap");
+
+        ard::small_ostringstream<8> app(std::string("ab"), ard::ios_base::app);
+        app << "cd";
+        expect(app.view() == "abcd" && app.rdbuf()->is_inline(), "str(s): appended with app");
+    }
+
+    void reserve()
+    {
+        ard::small_ostringstream<8> os;
+        os << "ab";
+        ard::small_stringbuf<8>* sb = os.rdbuf();
+        char* p = sb->sputreserve(4);
+        expect(p && sb->is_inline(), "sputreserve: room inline");
+        if (p) {
+            memcpy(p, "cdef", 4);
+            sb->sputcommit(4);
+        }
+        expect(os.view() == "abcdef", "sputreserve: committed inline");
+
+        p = sb->sputreserve(10);
+        expect(p && !sb->is_inline(), "sputreserve: spills when it does not fit");
+        if (p) {
+            memcpy(p, "0123456789", 10);
+            sb->sputcommit(10);
+        }
+        expect(os.view() == "abcdef0123456789", "sputreserve: content kept on spill");
+    }
+
+    void input_only()
+    {
+        ard::small_stringbuf<8> sb(ard::ios_base::in);
+        sb.str("12 34");
+        ard::istream in(&sb);
+        int a = 0, b = 0;
+        in >> a >> b;
+        expect(a == 12 && b == 34 && in.eof(), "input only: reads the content");
+        expect(sb.str() == "12 34", "input only: str()");
+
+        // Not writable
+        ard::ostream out(&sb);
+        out << 'x';
+        expect(out.bad() && sb.str() == "12 34", "input only: output fails");
+
+        ard::small_stringbuf<8> io;
+        io.str("ab");
+        ard::istream rin(&io);
+        expect(rin.get() == 'a' && rin.get() == 'b', "in/out: reads inline content");
+    }
+}
+
+int main()
+{
+    spill();
+    set_str();
+    reserve();
+    input_only();
+
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,128 @@
+// Copyright (C) 2019 Vladimir Talybin.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+// Span streams: output that overflows the array and input parsed in
+// place from arrays and string literals.
+
+#include "arduino.h"
+#include <ard-streams.h>
+#include <cstdio>
+#include <cstring>
+
+namespace
+{
+    int failures = 0;
+
+    void expect(bool ok, const char* what)
+    {
+        if (!ok) {
+            ++failures;
+            printf("FAILED: %s\n", what);
+        }
+    }
+
+    bool equal(ard::span<char> s, const char* str)
+    { return s.size() == strlen(str) && memcmp(s.data(), str, s.size()) == 0; }
+
+    void output()
+    {
+        char buf[8];
+        ard::ospanstream out(buf);
+        out << "1234" << 5678;
+        expect(out.good() && !out.rdbuf()->overflowed(), "out: exactly full");
+        expect(equal(out.span(), "12345678"), "out: span() of a full array");
+
+        out << 9;
+        expect(out.bad() && out.rdbuf()->overflowed(), "out: overflow sets badbit");
+        expect(equal(out.span(), "12345678"), "out: what fit is kept");
+
+        out.clear();
+        out << 'x';
+        expect(out.bad() && out.rdbuf()->overflowed(), "out: still full after clear()");
+
+        // A new array starts over
+        out.clear();
+        out.span(buf);
+        expect(!out.rdbuf()->overflowed() && out.span().size() == 0, "out: span() resets");
+        out << "ab";
+        expect(out.good() && equal(out.span(), "ab"), "out: writes to the new array");
+
+        // Padding that does not fit
+        out.width(10);
+        out << 1;
+        expect(out.bad() && out.rdbuf()->overflowed(), "out: padding overflows");
+        expect(equal(out.span(), "ab      "), "out: padding up to the end");
+    }
+
+    void input()
+    {
+        // The terminating null of a literal is not input
+        ard::ispanstream in("12 34");
+        int a = 0, b = 0, c = 0;
+        in >> a >> b;
+        expect(a == 12 && b == 34 && in.eof() && !in.fail(), "literal: ends at the last character");
+        expect(in.rdbuf()->span().size() == 5, "literal: without its null");
+        in >> c;
+        expect(in.fail() && c == 0, "literal: nothing after it");
+
+        ard::ispanstream words("ab");
+        std::string s;
+        words >> s;
+        expect(s == "ab" && words.eof(), "literal: no null in a string");
+
+        in.clear();
+        in.span("7");
+        in >> c;
+        expect(c == 7 && in.eof() && !in.fail(), "literal: given to span()");
+
+        // A constant array without a null is all input
+        const char raw[] = { '5', '6' };
+        ard::ispanstream rin(raw);
+        rin >> a;
+        expect(a == 56 && rin.eof(), "array: not null terminated");
+
+        // A writable array is taken whole, nulls included
+        char packet[4] = { '8', ' ', '9', '\0' };
+        ard::ispanstream pin(packet);
+        pin >> a;
+        expect(a == 8 && pin.rdbuf()->span().size() == 4, "array: writable array whole");
+
+        // An explicit span is taken as it is
+        const char* p = "3 4";
+        ard::ispanstream sin(ard::span<const char>(p, 1));
+        sin >> a;
+        expect(a == 3 && sin.eof(), "span: given size");
+    }
+
+    void in_out()
+    {
+        char buf[16];
+        ard::spanstream io(buf);
+        io << 42 << ' ' << 1.5;
+        int n = 0;
+        double d = 0;
+        io >> n >> d;
+        expect(n == 42 && d == 1.5 && !io.fail(), "inout: reads back what was written");
+    }
+}
+
+int main()
+{
+    output();
+    input();
+    in_out();
+
+    return failures ? 1 : 0;
+}
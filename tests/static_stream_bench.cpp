@@ -0,0 +1,274 @@
+// Copyright (C) 2019 Vladimir Talybin.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+// Per character and per number cost of the static streams against the
+// basic streams over the same kind of buffer. The flash saved by not
+// generating vtables can not be seen here, compare the sketch sizes
+// the Arduino build reports for the board instead.
+//
+//   static_stream_bench [characters]
+
+#include "arduino.h"
+#include <ard-streams.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+namespace
+{
+    // Takes everything and counts it
+    struct null_serial : Stream
+    {
+        size_t count = 0;
+
+        size_t write(uint8_t) override
+        {
+            ++count;
+            return 1;
+        }
+
+        size_t write(const uint8_t*, size_t n) override
+        {
+            count += n;
+            return n;
+        }
+
+        int available() override
+        { return 0; }
+
+        int read() override
+        { return -1; }
+
+        int peek() override
+        { return -1; }
+    };
+
+    // Reads a string
+    struct text_serial : Stream
+    {
+        const std::string& text;
+        size_t pos = 0;
+
+        explicit text_serial(const std::string& s)
+        : text(s)
+        { }
+
+        size_t write(uint8_t) override
+        { return 0; }
+
+        int available() override
+        { return int(text.size() - pos); }
+
+        int read() override
+        { return pos < text.size() ? static_cast<unsigned char>(text[pos++]) : -1; }
+
+        int peek() override
+        { return pos < text.size() ? static_cast<unsigned char>(text[pos]) : -1; }
+    };
+
+    // Best of five, in ns per unit. run() sets up the stream, does
+    // the work and returns a checksum, which must be the same for both.
+    template <class Run>
+    double best(size_t units, Run run, unsigned long long& check)
+    {
+        double t = 1e30;
+        for (int r = 0; r < 5; ++r) {
+            const auto t0 = std::chrono::steady_clock::now();
+            check = run();
+            const auto t1 = std::chrono::steady_clock::now();
+            t = std::min(t, std::chrono::duration<double, std::nano>(t1 - t0).count());
+        }
+        return t / units;
+    }
+
+    template <class Basic, class Static>
+    void bench(const char* name, size_t units, Basic basic, Static stat)
+    {
+        unsigned long long a, b;
+        const double tb = best(units, basic, a);
+        const double ts = best(units, stat, b);
+        printf("%-34s %7.2f ns basic %7.2f ns static %5.2fx%s\n",
+               name, tb, ts, tb / ts, a == b ? "" : " (results differ)");
+    }
+
+    //
+    // Output, returns what was written
+    //
+
+    template <class OStream>
+    unsigned long long put_chars(OStream& out, size_t n)
+    {
+        for (size_t i = 0; i < n; ++i)
+            out.put(char('a' + i % 26));
+        return out.good();
+    }
+
+    template <class OStream>
+    unsigned long long insert_chars(OStream& out, size_t n)
+    {
+        for (size_t i = 0; i < n; ++i)
+            out << char('a' + i % 26);
+        return out.good();
+    }
+
+    template <class OStream>
+    unsigned long long insert_ints(OStream& out, size_t n)
+    {
+        for (size_t i = 0; i < n; ++i)
+            out << int(i * 7919 % 100000) << ' ';
+        return out.good();
+    }
+
+    // Each output workload into a string and into serial with and
+    // without an output buffer
+    template <class Work>
+    void output(const char* what, size_t n, Work work)
+    {
+        char line[80];
+
+        snprintf(line, sizeof(line), "%s, string", what);
+        bench(line, n,
+            [&] {
+                ard::ostringstream out;
+                const unsigned long long ok = work(out, n);
+                return ok + out.rdbuf()->str().size();
+            },
+            [&] {
+                ard::static_stringbuf sb;
+                ard::static_ostream<ard::static_stringbuf> out(sb);
+                const unsigned long long ok = work(out, n);
+                return ok + sb.str().size();
+            });
+
+        snprintf(line, sizeof(line), "%s, serial 64", what);
+        bench(line, n,
+            [&] {
+                null_serial ser;
+                char obuf[64];
+                {
+                    ard::oserialstream out(ser, obuf, sizeof(obuf));
+                    if (!work(out, n))
+                        return 0ull;
+                }
+                return (unsigned long long)ser.count;
+            },
+            [&] {
+                null_serial ser;
+                {
+                    ard::static_serialbuf<64> sb(ser);
+                    ard::static_ostream<ard::static_serialbuf<64>> out(sb);
+                    if (!work(out, n))
+                        return 0ull;
+                }
+                return (unsigned long long)ser.count;
+            });
+
+        snprintf(line, sizeof(line), "%s, serial unbuffered", what);
+        bench(line, n,
+            [&] {
+                null_serial ser;
+                ard::oserialstream out(ser);
+                return work(out, n) ? (unsigned long long)ser.count : 0;
+            },
+            [&] {
+                null_serial ser;
+                ard::static_serialbuf<0> sb(ser);
+                ard::static_ostream<ard::static_serialbuf<0>> out(sb);
+                return work(out, n) ? (unsigned long long)ser.count : 0;
+            });
+    }
+
+    //
+    // Input, returns a sum of what was read
+    //
+
+    template <class IStream>
+    unsigned long long get_chars(IStream& in)
+    {
+        unsigned long long sum = 0;
+        for (int c; (c = in.get()) != EOF; )
+            sum += c;
+        return sum;
+    }
+
+    template <class IStream>
+    unsigned long long extract_ints(IStream& in)
+    {
+        unsigned long long sum = 0;
+        for (int v = 0; in >> v; )
+            sum += v;
+        return sum;
+    }
+
+    template <class Work>
+    void input(const char* what, const std::string& text, size_t units, Work work)
+    {
+        char line[80];
+
+        snprintf(line, sizeof(line), "%s, string", what);
+        bench(line, units,
+            [&] {
+                ard::istringstream in(text);
+                return work(in);
+            },
+            [&] {
+                ard::static_stringbuf sb(text);
+                ard::static_istream<ard::static_stringbuf> in(sb);
+                return work(in);
+            });
+
+        snprintf(line, sizeof(line), "%s, serial 64", what);
+        bench(line, units,
+            [&] {
+                text_serial ser(text);
+                char ibuf[64];
+                ard::basic_serialbuf<char> sb(ser, ard::ios_base::in);
+                sb.setibuf(ibuf, sizeof(ibuf));
+                ard::istream in(&sb);
+                return work(in);
+            },
+            [&] {
+                text_serial ser(text);
+                ard::static_serialbuf<0, 64> sb(ser);
+                ard::static_istream<ard::static_serialbuf<0, 64>> in(sb);
+                return work(in);
+            });
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const size_t n = argc > 1 ? strtoul(argv[1], nullptr, 0) : 1000000;
+
+    output("put()", n,
+        [](auto& out, size_t k) { return put_chars(out, k); });
+    output("operator<<(char)", n,
+        [](auto& out, size_t k) { return insert_chars(out, k); });
+    output("operator<<(int)", n / 8,
+        [](auto& out, size_t k) { return insert_ints(out, k); });
+
+    std::string chars, ints;
+    for (size_t i = 0; i < n; ++i)
+        chars += char('a' + i % 26);
+    for (size_t i = 0; i < n / 8; ++i)
+        ints += std::to_string(i * 7919 % 100000) + ' ';
+
+    input("get()", chars, n,
+        [](auto& in) { return get_chars(in); });
+    input("operator>>(int)", ints, n / 8,
+        [](auto& in) { return extract_ints(in); });
+
+    printf("Flash is not measured on the host, see the sketch size for the board\n");
+}
@@ -0,0 +1,126 @@
+// Copyright (C) 2019 Vladimir Talybin.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+// Extraction of int from a string stream with and without a tied
+// serial output stream: idle, written to now and then, and over a
+// buffer that cannot tell whether output is waiting, which is synced
+// before every extraction as all tied streams were before. Syncs of
+// the tied stream are counted.
+//
+//   tie_bench [values]
+
+#include "arduino.h"
+#include <ard-streams.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+namespace
+{
+    // Takes everything and counts it
+    struct null_serial : Stream
+    {
+        size_t count = 0;
+
+        size_t write(uint8_t) override
+        {
+            ++count;
+            return 1;
+        }
+
+        size_t write(const uint8_t*, size_t n) override
+        {
+            count += n;
+            return n;
+        }
+
+        int available() override
+        { return 0; }
+
+        int read() override
+        { return -1; }
+
+        int peek() override
+        { return -1; }
+    };
+
+    // Serial output counting its syncs. Without an output buffer it
+    // does not report what is waiting.
+    struct counted_serialbuf : ard::basic_serialbuf<char>
+    {
+        unsigned long long syncs = 0;
+
+        counted_serialbuf(Stream& ser, char* obuf, std::streamsize n)
+        : ard::basic_serialbuf<char>(ser, ard::ios_base::out)
+        { this->setobuf(obuf, n); }
+
+    protected:
+        int sync() override
+        {
+            ++syncs;
+            return ard::basic_serialbuf<char>::sync();
+        }
+
+        std::streamsize xsputwaiting() override
+        { return -1; }
+    };
+
+    // Best of five in ns per value. every is how many values are read
+    // per character written to the tied stream, 0 for none.
+    void run(const char* name, const std::string& text, size_t count,
+             bool tie, bool buffered, size_t every)
+    {
+        double best = 1e30;
+        unsigned long long syncs = 0, sum = 0;
+        for (int r = 0; r < 5; ++r) {
+            null_serial ser;
+            char obuf[64];
+            counted_serialbuf sb(ser, buffered ? obuf : nullptr, sizeof(obuf));
+            ard::ostream out(&sb);
+            ard::istringstream in(text);
+            if (tie)
+                in.tie(&out);
+
+            sum = 0;
+            const auto t0 = std::chrono::steady_clock::now();
+            size_t i = 0;
+            for (int v = 0; in >> v; ++i) {
+                sum += v;
+                if (every && i % every == 0)
+                    out.put('.');
+            }
+            const auto t1 = std::chrono::steady_clock::now();
+            syncs = sb.syncs;
+            best = std::min(best, std::chrono::duration<double, std::nano>(t1 - t0).count());
+        }
+        printf("  %-28s %7.2f ns/value %8llu syncs (sum %llu)\n",
+               name, best / count, syncs, sum);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const size_t count = argc > 1 ? strtoul(argv[1], nullptr, 0) : 200000;
+
+    std::string text;
+    for (size_t i = 0; i < count; ++i)
+        text += std::to_string(i * 7919 % 100000) + ' ';
+
+    printf("operator>>(int), %zu values\n", count);
+    run("no tie", text, count, false, true, 0);
+    run("tie, idle", text, count, true, true, 0);
+    run("tie, 1 write per 64 values", text, count, true, true, 64);
+    run("tie, unbuffered, unknown", text, count, true, false, 0);
+}
@@ -0,0 +1,165 @@
+// Copyright (C) 2019 Vladimir Talybin.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+// Input from a stream tied to an output stream: output waiting in the
+// tied stream reaches the device before the input is read, an idle
+// tied stream is not synced, and a buffer that cannot tell is synced
+// every time as before.
+
+#include "arduino.h"
+#include <ard-streams.h>
+#include <cstdio>
+#include <string>
+
+namespace
+{
+    int failures = 0;
+
+    void expect(bool ok, const char* what)
+    {
+        if (!ok) {
+            ++failures;
+            printf("FAILED: %s\n", what);
+        }
+    }
+
+    // Keeps what had been written when input was first asked for
+    struct prompt_serial : memory_serial
+    {
+        std::string seen;
+        bool asked = false;
+
+        int read() override
+        {
+            ask_();
+            return memory_serial::read();
+        }
+
+        int peek() override
+        {
+            ask_();
+            return memory_serial::peek();
+        }
+
+    private:
+        void ask_()
+        {
+            if (!asked)
+                seen = out;
+            asked = true;
+        }
+    };
+
+    // Buffered output collected in out, counting the syncs
+    struct sync_counter : ard::basic_streambuf<char>
+    {
+        std::string out;
+        int syncs = 0;
+        char buf[64];
+
+        sync_counter()
+        { this->setp(buf, buf + sizeof(buf)); }
+
+    protected:
+        int sync() override
+        {
+            ++syncs;
+            out.append(this->pbase(), this->pptr());
+            this->setp(buf, buf + sizeof(buf));
+            return 0;
+        }
+    };
+
+    // No put area and no xsputwaiting(), so waiting output is unknown
+    struct opaque_buf : ard::basic_streambuf<char>
+    {
+        int syncs = 0;
+
+    protected:
+        int sync() override
+        {
+            ++syncs;
+            return 0;
+        }
+    };
+
+    // A prompt written to the serial stream before the answer is read
+    void prompt()
+    {
+        const ard::serial_flush policies[] = { ard::serial_flush::full, ard::serial_flush::line };
+        for (ard::serial_flush policy : policies) {
+            const char* what = policy == ard::serial_flush::full ?
+                "prompt: buffered output flushed before >>" :
+                "prompt: line buffered output flushed before >>";
+
+            prompt_serial ser;
+            ser.feed("42\n");
+            char obuf[16];
+            ard::oserialstream out(ser, obuf, sizeof(obuf), policy);
+            ard::iserialstream in(ser);
+            in.tie(&out);
+
+            out << "value? ";
+            expect(ser.out.empty(), "prompt: held in the buffer");
+            int v = 0;
+            in >> v;
+            expect(v == 42 && ser.seen == "value? ", what);
+        }
+    }
+
+    void idle()
+    {
+        sync_counter sb;
+        ard::ostream out(&sb);
+        ard::istringstream in("1 2 3 4 5");
+        in.tie(&out);
+
+        int v = 0;
+        in >> v >> v;
+        expect(sb.syncs == 0, "idle: tied stream not synced");
+
+        out << "x";
+        in >> v;
+        expect(sb.syncs == 1 && sb.out == "x", "idle: synced with output waiting");
+        in >> v;
+        expect(sb.syncs == 1 && v == 4, "idle: not synced again");
+
+        // Unformatted input as well
+        out << "y";
+        in.peek();
+        expect(sb.syncs == 2 && sb.out == "xy", "idle: synced before peek()");
+    }
+
+    void unknown()
+    {
+        opaque_buf sb;
+        ard::ostream out(&sb);
+        ard::istringstream in("1 2 3");
+        in.tie(&out);
+
+        int v = 0;
+        in >> v >> v >> v;
+        expect(sb.syncs == 3, "unknown: synced before each extraction");
+    }
+}
+
+int main()
+{
+    prompt();
+    idle();
+    unknown();
+
+    return failures ? 1 : 0;
+}